@@ -0,0 +1,188 @@
+#include "concurrent/buffer_pool.h"
+#include <mutex>
+#include <new>
+
+namespace ipc::core {
+
+/* Buffers a thread keeps per size class before handing a batch to the shared list */
+static constexpr size_t BP_CACHE_LIMIT = 32;
+static constexpr size_t BP_BATCH = BP_CACHE_LIMIT / 2;
+/* Buffers parked on a shared list per size class, the rest is freed */
+static constexpr size_t BP_SHARED_LIMIT = 1024;
+
+namespace {
+
+struct free_list {
+    buffer_block *head = nullptr;
+    size_t count = 0;
+
+    void push(buffer_block *block) noexcept {
+        block->next = head;
+        head = block;
+        count++;
+    }
+
+    buffer_block *pop() noexcept {
+        buffer_block *block = head;
+        if (block != nullptr) {
+            head = block->next;
+            count--;
+        }
+        return block;
+    }
+};
+
+struct shared_lists {
+    std::mutex mtx[buffer_pool::class_count];
+    free_list lists[buffer_pool::class_count];
+};
+
+/* Never destroyed, buffers may still be released while statics are torn down */
+shared_lists &shared() {
+    static shared_lists *lists = new shared_lists();
+    return *lists;
+}
+
+void free_block(buffer_block *block) noexcept {
+    block->~buffer_block();
+    ::operator delete(block);
+}
+
+buffer_block *new_block(size_t capacity, uint32_t size_class) noexcept {
+    void *mem = ::operator new(sizeof(buffer_block) + capacity, std::nothrow);
+    if (mem == nullptr) {
+        return nullptr;
+    }
+    buffer_block *block = new (mem) buffer_block;
+    block->size_class = size_class;
+    block->capacity = capacity;
+    block->next = nullptr;
+    return block;
+}
+
+/* Move up to count blocks to the shared list, free what does not fit */
+void give_back(size_t cls, free_list &from, size_t count) noexcept {
+    auto &sh = shared();
+    std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+    while (count-- > 0 && from.head != nullptr) {
+        buffer_block *block = from.pop();
+        if (sh.lists[cls].count < BP_SHARED_LIMIT) {
+            sh.lists[cls].push(block);
+        } else {
+            free_block(block);
+        }
+    }
+}
+
+/* 0 not created yet, 1 alive, 2 destroyed; plain flag so it can be read during thread exit */
+thread_local int t_cache_state = 0;
+
+struct thread_cache {
+    free_list lists[buffer_pool::class_count];
+
+    thread_cache() { t_cache_state = 1; }
+    ~thread_cache() {
+        t_cache_state = 2;
+        for (size_t cls = 0; cls < buffer_pool::class_count; cls++) {
+            give_back(cls, lists[cls], lists[cls].count);
+        }
+    }
+};
+
+thread_local thread_cache t_cache;
+
+thread_cache *local_cache() noexcept {
+    return (t_cache_state != 2 ? &t_cache : nullptr);
+}
+
+size_t class_of(size_t capacity) noexcept {
+    for (size_t cls = 0; cls < buffer_pool::class_count; cls++) {
+        if (capacity <= buffer_pool::class_sizes[cls]) {
+            return cls;
+        }
+    }
+    return buffer_pool::class_count;
+}
+
+} // namespace
+
+buffer_ref buffer_pool::acquire(size_t capacity) {
+    size_t cls = class_of(capacity);
+    buffer_block *block = nullptr;
+
+    if (cls == class_count) {
+        block = new_block(capacity, unpooled);
+    } else {
+        thread_cache *cache = local_cache();
+        if (cache != nullptr) {
+            free_list &local = cache->lists[cls];
+            if (local.head == nullptr) {
+                /* Refill a batch at once so the shared lock is taken rarely */
+                auto &sh = shared();
+                std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+                for (size_t i = 0; i < BP_BATCH && sh.lists[cls].head != nullptr; i++) {
+                    local.push(sh.lists[cls].pop());
+                }
+            }
+            block = local.pop();
+        } else {
+            auto &sh = shared();
+            std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+            block = sh.lists[cls].pop();
+        }
+        if (block == nullptr) {
+            block = new_block(class_sizes[cls], static_cast<uint32_t>(cls));
+        }
+    }
+
+    if (block == nullptr) {
+        return buffer_ref();
+    }
+    block->refs.store(1, std::memory_order_relaxed);
+    block->size = 0;
+    block->next = nullptr;
+    return buffer_ref(block);
+}
+
+bool buffer_pool::reserve(buffer_ref &buff, size_t capacity) {
+    if (buff.unique() && buff.capacity() >= capacity) {
+        buff.resize(0);
+        return true;
+    }
+    buff = acquire(capacity);
+    return static_cast<bool>(buff);
+}
+
+void buffer_pool::release(buffer_block *block) noexcept {
+    if (block->size_class == unpooled) {
+        free_block(block);
+        return;
+    }
+
+    size_t cls = block->size_class;
+    thread_cache *cache = local_cache();
+    if (cache == nullptr) {
+        free_list single;
+        single.push(block);
+        give_back(cls, single, 1);
+        return;
+    }
+
+    free_list &local = cache->lists[cls];
+    local.push(block);
+    if (local.count > BP_CACHE_LIMIT) {
+        give_back(cls, local, BP_BATCH);
+    }
+}
+
+void buffer_pool::trim() {
+    auto &sh = shared();
+    for (size_t cls = 0; cls < class_count; cls++) {
+        std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+        while (buffer_block *block = sh.lists[cls].pop()) {
+            free_block(block);
+        }
+    }
+}
+
+} // namespace ipc::core
@@ -0,0 +1,106 @@
+#include "concurrent/endpoint.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <functional>
+
+namespace ipc::core {
+static constexpr size_t EP_CHUNK_SIZE = 1024;
+static constexpr size_t EP_CHUNK_COUNT = 1024;
+static constexpr size_t EP_CACHE_SIZE = 64;
+
+namespace {
+/* Names live in chunks that never move, so name() reads them without the lock */
+struct endpoint_table {
+    std::shared_mutex mtx{};
+    std::unordered_map<std::string_view, endpoint_id> ids{};
+    std::atomic<std::string *> chunks[EP_CHUNK_COUNT] = {};
+    std::atomic<endpoint_id> count{1};
+
+    endpoint_table() {
+        chunks[0].store(new std::string[EP_CHUNK_SIZE]);
+        ids.emplace(std::string_view(chunks[0].load()[0]), endpoint::none);
+    }
+};
+
+/* Never destroyed, detached workers may still read names while statics are torn down */
+endpoint_table &table() {
+    static endpoint_table *s_table = new endpoint_table();
+    return *s_table;
+}
+
+/* Ids never change, so a thread keeps the names it used without ever invalidating them */
+struct cache_entry {
+    std::string name{};
+    endpoint_id id = endpoint::none;
+};
+
+cache_entry &cached(const std::string &name) {
+    thread_local cache_entry s_cache[EP_CACHE_SIZE];
+    return s_cache[std::hash<std::string>()(name) % EP_CACHE_SIZE];
+}
+
+const std::string &empty_name() {
+    static const std::string s_empty;
+    return s_empty;
+}
+} // namespace
+
+endpoint_id endpoint::intern(const std::string &name) {
+    cache_entry &entry = cached(name);
+    if (entry.id != none && entry.name == name) {
+        return entry.id;
+    }
+
+    endpoint_table &t = table();
+    {
+        std::shared_lock<std::shared_mutex> lock(t.mtx);
+        auto it = t.ids.find(name);
+        if (it != t.ids.end()) {
+            entry.name = name;
+            entry.id = it->second;
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(t.mtx);
+    auto it = t.ids.find(name);
+    if (it != t.ids.end()) {
+        return it->second;
+    }
+    endpoint_id id = t.count.load(std::memory_order_relaxed);
+    size_t chunk = id / EP_CHUNK_SIZE;
+    if (chunk >= EP_CHUNK_COUNT) {
+        throw std::length_error("endpoint table full");
+    }
+    std::string *names = t.chunks[chunk].load(std::memory_order_relaxed);
+    if (names == nullptr) {
+        names = new std::string[EP_CHUNK_SIZE];
+        t.chunks[chunk].store(names, std::memory_order_release);
+    }
+    names[id % EP_CHUNK_SIZE] = name;
+    t.ids.emplace(std::string_view(names[id % EP_CHUNK_SIZE]), id);
+    t.count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+endpoint_id endpoint::find(const std::string &name) {
+    endpoint_table &t = table();
+    std::shared_lock<std::shared_mutex> lock(t.mtx);
+    auto it = t.ids.find(name);
+    return (it != t.ids.end() ? it->second : none);
+}
+
+const std::string &endpoint::name(endpoint_id id) {
+    endpoint_table &t = table();
+    if (id >= t.count.load(std::memory_order_acquire)) {
+        return empty_name();
+    }
+    return t.chunks[id / EP_CHUNK_SIZE].load(std::memory_order_acquire)[id % EP_CHUNK_SIZE];
+}
+
+} // namespace ipc::core
@@ -5,7 +5,7 @@ namespace ipc::core {
 
 evloop::evloop(worker_ptr worker) :
     m_impl(std::make_unique<evloop_p>(get_new_id<id_provider_type::EventLoop>(), std::move(worker))) {
-    m_impl->m_main_handle = make_handle(std::bind(&evloop::run, this, std::placeholders::_1));
+    m_impl->set_main_handle(make_handle(std::bind(&evloop::run, this, std::placeholders::_1)));
 }
 
 evloop::~evloop() {
@@ -35,6 +35,14 @@ void evloop::set_handle(handle_w_ptr handle) {
     m_impl->set_handle(handle);
 }
 
+void evloop::add_route(const std::string &receiver, handle_w_ptr handle) {
+    m_impl->add_route(receiver, std::move(handle));
+}
+
+int evloop::remove_route(const std::string &receiver) {
+    return m_impl->remove_route(receiver);
+}
+
 const_worker_ptr evloop::get_worker() const {
     return m_impl->get_worker();
 }
@@ -43,6 +51,10 @@ void evloop::post(message_ptr mesg) {
     m_impl->post(std::move(mesg));
 }
 
+void evloop::post(message_ptr mesg, worker::Priority priority) {
+    m_impl->post(std::move(mesg), priority);
+}
+
 void evloop::run(message_ptr mesg) {
     (void)(mesg);
 }
@@ -3,17 +3,20 @@
 #include <future>
 #include "eventloop_p.h"
 #include <iostream>
+#include <algorithm>
 
 namespace ipc::core {
 
+static constexpr size_t EL_MAILBOX_SIZE = 256;
+static constexpr size_t EL_DRAIN_BATCH = 256;
+
 evloop_p::evloop_p(int id, worker_ptr worker) :
     m_mtx{},
     m_id(id),
     m_state(static_cast<int>(state::Created)),
     m_main_handle({}),
-    m_sub_handle({}),
-    m_task_commpleted_cb(std::function<void(ipc::core::task_base_ptr)>(std::bind(&evloop_p::task_completed, this, std::placeholders::_1))),
-    m_worker(worker) {
+    m_worker(worker),
+    m_mail(std::make_shared<mail_state>(worker.get(), EL_MAILBOX_SIZE)) {
 }
 
 evloop_p::~evloop_p() {
@@ -57,8 +60,67 @@ int evloop_p::wait() {
     return ret;
 }
 
+void evloop_p::set_main_handle(evloop::handle_s_ptr handle) {
+    std::lock_guard<std::mutex> lock(m_mail->handle_mtx);
+    m_main_handle = handle;
+    m_mail->main_handle = handle;
+}
+
 void evloop_p::set_handle(evloop::handle_w_ptr handle) {
-    m_sub_handle = handle;
+    std::lock_guard<std::mutex> lock(m_mail->handle_mtx);
+    m_mail->sub_handle = handle;
+}
+
+void evloop_p::add_route(const std::string &receiver, evloop::handle_w_ptr handle) {
+    std::lock_guard<std::mutex> lock(m_mail->route_mtx);
+    auto routes = std::make_shared<route_table>();
+    if (m_mail->routes != nullptr) {
+        *routes = *m_mail->routes;
+    }
+
+    if (!receiver.empty() && receiver.back() == '*') {
+        std::string prefix = receiver.substr(0, receiver.size() - 1);
+        auto it = std::find_if(routes->prefixes.begin(), routes->prefixes.end(), [&prefix](const auto &route) { return route.first == prefix; });
+        if (it != routes->prefixes.end()) {
+            it->second = std::move(handle);
+        } else {
+            routes->prefixes.emplace_back(std::move(prefix), std::move(handle));
+            std::stable_sort(routes->prefixes.begin(), routes->prefixes.end(), [](const auto &a, const auto &b) { return a.first.size() > b.first.size(); });
+        }
+    } else {
+        routes->exact[endpoint::intern(receiver)] = std::move(handle);
+    }
+    std::atomic_store(&m_mail->routes, std::shared_ptr<const route_table>(std::move(routes)));
+}
+
+int evloop_p::remove_route(const std::string &receiver) {
+    std::lock_guard<std::mutex> lock(m_mail->route_mtx);
+    if (m_mail->routes == nullptr) {
+        return -1;
+    }
+    auto routes = std::make_shared<route_table>(*m_mail->routes);
+    size_t removed = 0;
+    if (!receiver.empty() && receiver.back() == '*') {
+        std::string prefix = receiver.substr(0, receiver.size() - 1);
+        auto it = std::find_if(routes->prefixes.begin(), routes->prefixes.end(), [&prefix](const auto &route) { return route.first == prefix; });
+        if (it != routes->prefixes.end()) {
+            routes->prefixes.erase(it);
+            removed = 1;
+        }
+    } else {
+        endpoint_id id = endpoint::find(receiver);
+        removed = (id != endpoint::none || receiver.empty() ? routes->exact.erase(id) : 0);
+    }
+    if (removed == 0) {
+        return -1;
+    }
+
+    std::shared_ptr<const route_table> next = nullptr;
+    if (!routes->exact.empty() || !routes->prefixes.empty()) {
+        next = std::move(routes);
+    }
+    std::atomic_store(&m_mail->routes, std::move(next));
+    return 0;
 }
 
 const_worker_ptr evloop_p::get_worker() const {
@@ -80,28 +142,127 @@ void evloop_p::set_state(evloop_p::state s) {
 }
 
 void evloop_p::post(message_ptr mesg) {
-    if (get_state() != static_cast<int>(state::Stoped)) {
-        m_worker->add_task(evloop_p::task_handle,
-                           m_task_commpleted_cb,
-                           std::move(mesg),
-                           evloop::handle_w_ptr(m_main_handle),
-                           evloop::handle_w_ptr(m_sub_handle));
+    post(std::move(mesg), worker::Normal);
+}
+
+void evloop_p::post(message_ptr mesg, worker::Priority priority) {
+    if (get_state() == static_cast<int>(state::Stoped)) {
+        return;
     }
+
+    mailbox &box = m_mail->boxes[priority];
+    box.count.fetch_add(1);
+    /* Once a message overflowed, later ones follow it until the drain took them */
+    if (box.overflowed.load() > 0 || !box.ring.push(mesg)) {
+        std::lock_guard<std::mutex> lock(box.overflow_mtx);
+        box.overflow.push_back(std::move(mesg));
+        box.overflowed.fetch_add(1);
+    }
+    if (!box.scheduled.exchange(true)) {
+        schedule(m_mail, priority);
+    }
+}
+
+void evloop_p::schedule(const std::shared_ptr<mail_state> &mail, worker::Priority priority) {
+    mail->owner->add_task(make_light_task(&evloop_p::drain, mail, priority), priority);
 }
 
-void evloop_p::task_completed(ipc::core::task_base_ptr task) {
+void evloop_p::drain(const std::shared_ptr<mail_state> &mail, worker::Priority priority) {
+    mailbox &box = mail->boxes[priority];
+    evloop::handle_s_ptr main_handle = nullptr;
+    evloop::handle_s_ptr sub_handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mail->handle_mtx);
+        main_handle = mail->main_handle.lock();
+        sub_handle = mail->sub_handle.lock();
+    }
+
+    /* The cache of resolved receivers is only valid for the table it was built from */
+    auto routes = std::atomic_load(&mail->routes);
+    if (routes != mail->resolved_table) {
+        mail->resolved.clear();
+        mail->resolved_table = routes;
+    }
+
+    size_t n = 0;
+    message_ptr mesg = nullptr;
+    while (n < EL_DRAIN_BATCH && take(box, mesg)) {
+        n++;
+        try {
+            evloop::handle_s_ptr route = nullptr;
+            if (routes != nullptr) {
+                route = resolve(*mail, *routes, mesg->receiver_id()).lock();
+            }
+            if (route != nullptr) {
+                (*route)(std::move(mesg));
+            } else {
+                if (main_handle != nullptr) {
+                    (*main_handle)(mesg);
+                }
+                if (sub_handle != nullptr) {
+                    (*sub_handle)(std::move(mesg));
+                }
+            }
+        } catch (...) {
+        }
+        mesg = nullptr;
+    }
+    box.count.fetch_sub(n);
+
+    /* A full batch yields to the other tasks of the worker and continues later */
+    if (n == EL_DRAIN_BATCH) {
+        schedule(mail, priority);
+        return;
+    }
+    /* Either a racing post() sees the flag cleared or we see its count, both are seq_cst */
+    box.scheduled.store(false);
+    if (box.count.load() > 0 && !box.scheduled.exchange(true)) {
+        schedule(mail, priority);
+    }
 }
 
-void evloop_p::task_handle(message_ptr mesg, evloop::handle_w_ptr main_handle, evloop::handle_w_ptr sub_handle) {
+const evloop::handle_w_ptr &evloop_p::resolve(mail_state &mail, const route_table &routes, endpoint_id receiver) {
+    auto it = mail.resolved.find(receiver);
+    if (it != mail.resolved.end()) {
+        return it->second;
+    }
 
-    auto ptr1 = main_handle.lock();
-    if (ptr1 != nullptr) {
-        (*ptr1)(mesg);
+    /* First message for this receiver since the table changed, unrouted ones are cached too */
+    evloop::handle_w_ptr handle{};
+    auto exact = routes.exact.find(receiver);
+    if (exact != routes.exact.end()) {
+        handle = exact->second;
+    } else {
+        const std::string &name = endpoint::name(receiver);
+        for (const auto &route : routes.prefixes) {
+            if (name.compare(0, route.first.size(), route.first) == 0) {
+                handle = route.second;
+                break;
+            }
+        }
     }
-    auto ptr2 = sub_handle.lock();
-    if (ptr2 != nullptr) {
-        (*ptr2)(std::move(mesg));
+    return mail.resolved.emplace(receiver, std::move(handle)).first->second;
+}
+
+bool evloop_p::take(mailbox &box, message_ptr &mesg) {
+    if (box.taken.empty()) {
+        if (box.ring.pop(mesg)) {
+            return true;
+        }
+        /* The overflow is younger than everything in the ring, claimed slots included */
+        if (!box.ring.empty() || box.overflowed.load() == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(box.overflow_mtx);
+        box.taken.swap(box.overflow);
+        box.overflowed.store(0);
+        if (box.taken.empty()) {
+            return false;
+        }
     }
+    mesg = std::move(box.taken.front());
+    box.taken.pop_front();
+    return true;
 }
 
 } // namespace ipc::core
@@ -1,6 +1,11 @@
 #include <shared_mutex>
 #include <mutex>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "mesg_p.h"
+#include "mpsc_ring_p.h"
 #include "concurrent/eventloop.h"
 #include "concurrent/worker.h"
 
@@ -9,6 +14,45 @@ class evloop_p {
     friend class evloop_man;
     friend class evloop;
 
+    /* Messages of one priority, drained by at most one task on the worker at a time */
+    struct mailbox {
+        explicit mailbox(size_t capacity) :
+            ring(capacity) {}
+
+        mpsc_ring<message_ptr> ring;
+        std::atomic<size_t> count{0};       ///< Posted and not yet taken, in flight included
+        std::atomic<bool> scheduled{false}; ///< A drain task is queued or running
+        std::atomic<size_t> overflowed{0};  ///< Messages waiting in overflow
+        std::mutex overflow_mtx{};
+        std::deque<message_ptr> overflow{}; ///< Used while the ring is full, keeps FIFO
+        std::deque<message_ptr> taken{};    ///< Overflow moved out by the drain, consumer only
+    };
+
+    /* Immutable once published, replaced as a whole when a route changes */
+    struct route_table {
+        std::unordered_map<endpoint_id, evloop::handle_w_ptr> exact{};
+        std::vector<std::pair<std::string, evloop::handle_w_ptr>> prefixes{}; ///< Longest first
+    };
+
+    /* Shared with the queued drain tasks, which may outlive the event loop */
+    struct mail_state {
+        mail_state(worker *w, size_t capacity) :
+            owner(w),
+            boxes{mailbox(capacity), mailbox(capacity), mailbox(capacity)} {}
+
+        worker *owner;
+        std::mutex handle_mtx{};
+        evloop::handle_w_ptr main_handle{};
+        evloop::handle_w_ptr sub_handle{};
+        std::mutex route_mtx{};
+        std::shared_ptr<const route_table> routes{nullptr};
+        mailbox boxes[worker::Low + 1];
+
+        /* Receivers resolved against resolved_table, used by the drains on the worker only */
+        std::shared_ptr<const route_table> resolved_table{nullptr};
+        std::unordered_map<endpoint_id, evloop::handle_w_ptr> resolved{};
+    };
+
 public:
     enum class state {
         Created,
@@ -23,7 +67,10 @@ public:
     int start();
     int stop();
     int wait();
+    void set_main_handle(evloop::handle_s_ptr handle);
     void set_handle(evloop::handle_w_ptr handle);
+    void add_route(const std::string &receiver, evloop::handle_w_ptr handle);
+    int remove_route(const std::string &receiver);
     const_worker_ptr get_worker() const;
     worker_ptr get_worker();
 
@@ -31,15 +78,17 @@ private:
     int get_state() const;
     void set_state(evloop_p::state s);
     void post(message_ptr mesg);
-    void task_completed(ipc::core::task_base_ptr task);
-    static void task_handle(message_ptr mesg, evloop::handle_w_ptr main_handle, evloop::handle_w_ptr sub_handle);
+    void post(message_ptr mesg, worker::Priority priority);
+    static void schedule(const std::shared_ptr<mail_state> &mail, worker::Priority priority);
+    static void drain(const std::shared_ptr<mail_state> &mail, worker::Priority priority);
+    static bool take(mailbox &box, message_ptr &mesg);
+    static const evloop::handle_w_ptr &resolve(mail_state &mail, const route_table &routes, endpoint_id receiver);
 
     mutable std::shared_mutex m_mtx = {};
     uint64_t m_id = 0;
     int m_state = 0;
     evloop::handle_s_ptr m_main_handle{};
-    evloop::handle_w_ptr m_sub_handle{};
-    std::function<void(ipc::core::task_base_ptr)> m_task_commpleted_cb = {nullptr};
     worker_ptr m_worker = nullptr;
+    std::shared_ptr<mail_state> m_mail = nullptr;
 };
 } // namespace ipc::core
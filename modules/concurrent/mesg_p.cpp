@@ -2,29 +2,70 @@
 #include <string.h>
 #include <atomic>
 #include "../identify/id_provider.h"
+#include "concurrent/task_pool.h"
 
 namespace ipc::core {
 static constexpr size_t MAXQUEUE = 1024;
 
 /**
- * @fn message_p(const std::string &sender, const std::string &receiver, const char *data, size_t size)
+ * @fn message_p(endpoint_id sender, endpoint_id receiver, const char *data, size_t size)
  * @brief Construct a new message p::message p object
  *
+ * Content too large for the inline string goes to a pooled buffer, or to the string
+ * when no buffer could be allocated.
+ *
  * @param sender
  * @param receiver
  * @param data
  * @param size
  */
-message_p::message_p(const std::string &sender, const std::string &receiver, const char *data, size_t size) :
+message_p::message_p(endpoint_id sender, endpoint_id receiver, const char *data, size_t size) :
     m_id(get_new_id<id_provider_type::Message>()),
     m_sender(sender),
     m_receiver(receiver) {
     if ((data != nullptr) && (size > 0)) {
-        m_data.resize(size);
-        memcpy(m_data.data(), data, size);
+        if (size > m_data.capacity()) {
+            m_body = buffer_pool::acquire(size);
+        }
+        if (m_body) {
+            memcpy(m_body.data(), data, size);
+            m_body.resize(size);
+        } else {
+            m_data.assign(data, size);
+        }
     }
 }
 
+/**
+ * @fn message_p(endpoint_id sender, endpoint_id receiver, std::string &&data)
+ * @brief Construct a new message p::message p object taking over the content
+ *
+ * @param sender
+ * @param receiver
+ * @param data
+ */
+message_p::message_p(endpoint_id sender, endpoint_id receiver, std::string &&data) :
+    m_id(get_new_id<id_provider_type::Message>()),
+    m_sender(sender),
+    m_receiver(receiver),
+    m_data(std::move(data)) {
+}
+
+/**
+ * @fn message_p(endpoint_id sender, endpoint_id receiver, buffer_ref body)
+ * @brief Construct a new message p::message p object sharing a pooled buffer
+ *
+ * @param sender
+ * @param receiver
+ * @param body
+ */
+message_p::message_p(endpoint_id sender, endpoint_id receiver, buffer_ref body) :
+    m_id(get_new_id<id_provider_type::Message>()),
+    m_sender(sender),
+    m_receiver(receiver),
+    m_body(std::move(body)) {
+}
+
 message_p::~message_p() {
 }
 
@@ -32,23 +73,32 @@ uint64_t message_p::id() const {
     return m_id;
 }
 
-std::string message_p::sender() const {
+const std::string &message_p::sender() const {
+    return endpoint::name(m_sender);
+}
+
+const std::string &message_p::receiver() const {
+    return endpoint::name(m_receiver);
+}
+
+endpoint_id message_p::sender_id() const {
     return m_sender;
 }
 
-std::string message_p::receiver() const {
+endpoint_id message_p::receiver_id() const {
     return m_receiver;
 }
 
 const char *message_p::data() const {
-    return m_data.data();
+    return (m_body ? m_body.data() : m_data.data());
 }
 
 size_t message_p::size() const {
-    return m_data.size();
+    return (m_body ? m_body.size() : m_data.size());
 }
 
 void message_p::setdata(const std::string &data) {
+    m_body.reset();
     m_data = data;
 }
 
@@ -105,8 +155,34 @@ size_t mesgqueue_p::size() const {
     return queue.size();
 }
 
+/* Messages and their control blocks come from the small object pool of the tasks */
+template <typename... Args>
+static message_ptr make_message(Args &&...args) {
+    return std::allocate_shared<message_p>(task_allocator<message_p>(), std::forward<Args>(args)...);
+}
+
 message_ptr message::create(const std::string &sender, const std::string &receiver, const std::string &content) {
-    return std::move(std::shared_ptr<message_p>(new message_p(sender, receiver, content.data(), content.size())));
+    return make_message(endpoint::intern(sender), endpoint::intern(receiver), content.data(), content.size());
+}
+
+message_ptr message::create(const std::string &sender, const std::string &receiver, std::string &&content) {
+    return make_message(endpoint::intern(sender), endpoint::intern(receiver), std::move(content));
+}
+
+message_ptr message::create(const std::string &sender, const std::string &receiver, buffer_ref content) {
+    return make_message(endpoint::intern(sender), endpoint::intern(receiver), std::move(content));
+}
+
+message_ptr message::create(endpoint_id sender, endpoint_id receiver, const std::string &content) {
+    return make_message(sender, receiver, content.data(), content.size());
+}
+
+message_ptr message::create(endpoint_id sender, endpoint_id receiver, std::string &&content) {
+    return make_message(sender, receiver, std::move(content));
+}
+
+message_ptr message::create(endpoint_id sender, endpoint_id receiver, buffer_ref content) {
+    return make_message(sender, receiver, std::move(content));
 }
 
 } // namespace ipc::core
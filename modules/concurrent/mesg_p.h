@@ -18,11 +18,15 @@ namespace ipc::core {
 class message_p : public message {
 
 public:
-    explicit message_p(const std::string &sender, const std::string &receiver, const char *data = nullptr, size_t size = 0);
+    explicit message_p(endpoint_id sender, endpoint_id receiver, const char *data = nullptr, size_t size = 0);
+    explicit message_p(endpoint_id sender, endpoint_id receiver, std::string &&data);
+    explicit message_p(endpoint_id sender, endpoint_id receiver, buffer_ref body);
     virtual ~message_p();
     virtual uint64_t id() const;
-    virtual std::string sender() const;
-    virtual std::string receiver() const;
+    virtual const std::string &sender() const;
+    virtual const std::string &receiver() const;
+    virtual endpoint_id sender_id() const;
+    virtual endpoint_id receiver_id() const;
     virtual const char *data() const;
     virtual size_t size() const;
 
@@ -30,9 +34,10 @@ public:
 
 private:
     uint64_t m_id = 0;
-    std::string m_sender = "";
-    std::string m_receiver = "";
-    std::string m_data = std::string();
+    endpoint_id m_sender = endpoint::none;
+    endpoint_id m_receiver = endpoint::none;
+    std::string m_data = std::string(); ///< Content that fits inline or was moved in
+    buffer_ref m_body = {};             ///< Content held in a pooled buffer
 };
 
 /**
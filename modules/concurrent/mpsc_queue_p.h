@@ -0,0 +1,78 @@
+#ifndef MPSC_QUEUE_P_H
+#define MPSC_QUEUE_P_H
+
+#include <atomic>
+
+namespace ipc::core {
+
+/**
+ * @class mpsc_queue
+ * @brief Intrusive lock-free multi-producer/single-consumer queue (Vyukov)
+ *
+ * Node must be default constructible and have a `std::atomic<Node *> next` member.
+ * push() is one atomic exchange and may be called from any thread, pop() must only
+ * be called from the consumer. The queue never owns nodes, remaining nodes are left
+ * to the owner on destruction.
+ */
+template <typename Node>
+class mpsc_queue {
+    mpsc_queue(const mpsc_queue &) = delete;
+    mpsc_queue &operator=(const mpsc_queue &) = delete;
+
+public:
+    mpsc_queue() :
+        m_stub{},
+        m_head(&m_stub),
+        m_tail(&m_stub) {
+        m_stub.next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    void push(Node *node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        /* Between the exchange and this store the node is invisible to pop() */
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @fn pop
+     * @brief Consumer only, returns nullptr when empty or when the next node is still
+     *        being linked by a producer
+     */
+    Node *pop() {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            m_tail = next;
+            return tail;
+        }
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        /* Last node, put the stub behind it so it can be handed out */
+        push(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            m_tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+private:
+    Node m_stub;
+    alignas(64) std::atomic<Node *> m_head;
+    alignas(64) Node *m_tail;
+};
+
+} // namespace ipc::core
+
+#endif // MPSC_QUEUE_P_H
@@ -0,0 +1,99 @@
+#ifndef MPSC_RING_P_H
+#define MPSC_RING_P_H
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+
+namespace ipc::core {
+
+/**
+ * @class mpsc_ring
+ * @brief Bounded lock-free multi-producer/single-consumer ring (Vyukov)
+ *
+ * Every slot carries a sequence number telling whether it is free for the producer of
+ * a given position or filled for the consumer. push() claims a position with one CAS
+ * and fails when the ring is full, pop() must only be called from the consumer.
+ */
+template <typename T>
+class mpsc_ring {
+    mpsc_ring(const mpsc_ring &) = delete;
+    mpsc_ring &operator=(const mpsc_ring &) = delete;
+
+    struct cell {
+        std::atomic<size_t> seq;
+        T item;
+    };
+
+public:
+    /**
+     * @param capacity  Rounded up to a power of two
+     */
+    explicit mpsc_ring(size_t capacity) :
+        m_mask(0),
+        m_cells(nullptr),
+        m_enqueue_pos(0),
+        m_dequeue_pos(0) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        m_mask = cap - 1;
+        m_cells.reset(new cell[cap]);
+        for (size_t i = 0; i < cap; i++) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /* Any thread, item is only moved from on success */
+    bool push(T &item) {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        cell *c = nullptr;
+        while (true) {
+            c = &m_cells[pos & m_mask];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        c->item = std::move(item);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer only, false when empty or when the next slot is still being written */
+    bool pop(T &item) {
+        cell *c = &m_cells[m_dequeue_pos & m_mask];
+        size_t seq = c->seq.load(std::memory_order_acquire);
+        if (seq != m_dequeue_pos + 1) {
+            return false;
+        }
+        item = std::move(c->item);
+        c->item = T();
+        c->seq.store(m_dequeue_pos + m_mask + 1, std::memory_order_release);
+        m_dequeue_pos++;
+        return true;
+    }
+
+    /* Consumer only, true when no position is claimed, not even one still being written */
+    bool empty() const {
+        return m_enqueue_pos.load(std::memory_order_acquire) == m_dequeue_pos;
+    }
+
+private:
+    size_t m_mask;
+    std::unique_ptr<cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_enqueue_pos;
+    alignas(64) size_t m_dequeue_pos;
+};
+
+} // namespace ipc::core
+
+#endif // MPSC_RING_P_H
@@ -100,7 +100,7 @@ bool task_chain::error() const {
 
 trigger_ptr task_chain::add_task(task_base_ptr task, trigger_ptr trigger) {
     m_impl->queue.emplace(std::move(task), trigger);
-    return std::move(trigger);
+    return trigger;
 }
 
 void task_chain::set_handle(const std::function<void(int)> &fnc) {
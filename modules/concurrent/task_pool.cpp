@@ -0,0 +1,162 @@
+#include "concurrent/task_pool.h"
+#include <mutex>
+
+namespace ipc::core {
+
+/* Blocks a thread keeps per size class before handing a batch to the shared list */
+static constexpr size_t TP_CACHE_LIMIT = 64;
+static constexpr size_t TP_BATCH = TP_CACHE_LIMIT / 2;
+/* Blocks parked on a shared list per size class, the rest is freed */
+static constexpr size_t TP_SHARED_LIMIT = 4096;
+
+namespace {
+
+/* Free blocks are linked through their first bytes */
+struct free_node {
+    free_node *next;
+};
+
+struct free_list {
+    free_node *head = nullptr;
+    size_t count = 0;
+
+    void push(void *ptr) noexcept {
+        free_node *node = static_cast<free_node *>(ptr);
+        node->next = head;
+        head = node;
+        count++;
+    }
+
+    void *pop() noexcept {
+        free_node *node = head;
+        if (node != nullptr) {
+            head = node->next;
+            count--;
+        }
+        return node;
+    }
+};
+
+struct shared_lists {
+    std::mutex mtx[task_pool::class_count];
+    free_list lists[task_pool::class_count];
+};
+
+/* Never destroyed, tasks may still be released while statics are torn down */
+shared_lists &shared() {
+    static shared_lists *lists = new shared_lists();
+    return *lists;
+}
+
+/* Move up to count blocks to the shared list, free what does not fit */
+void give_back(size_t cls, free_list &from, size_t count) noexcept {
+    auto &sh = shared();
+    std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+    while (count-- > 0 && from.head != nullptr) {
+        void *ptr = from.pop();
+        if (sh.lists[cls].count < TP_SHARED_LIMIT) {
+            sh.lists[cls].push(ptr);
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+}
+
+/* 0 not created yet, 1 alive, 2 destroyed; plain flag so it can be read during thread exit */
+thread_local int t_cache_state = 0;
+
+struct thread_cache {
+    free_list lists[task_pool::class_count];
+
+    thread_cache() { t_cache_state = 1; }
+    ~thread_cache() {
+        t_cache_state = 2;
+        for (size_t cls = 0; cls < task_pool::class_count; cls++) {
+            give_back(cls, lists[cls], lists[cls].count);
+        }
+    }
+};
+
+thread_local thread_cache t_cache;
+
+thread_cache *local_cache() noexcept {
+    return (t_cache_state != 2 ? &t_cache : nullptr);
+}
+
+size_t class_of(size_t size) noexcept {
+    for (size_t cls = 0; cls < task_pool::class_count; cls++) {
+        if (size <= task_pool::class_sizes[cls]) {
+            return cls;
+        }
+    }
+    return task_pool::class_count;
+}
+
+} // namespace
+
+void *task_pool::allocate(size_t size) {
+    size_t cls = class_of(size);
+    if (cls == class_count) {
+        return ::operator new(size);
+    }
+
+    void *ptr = nullptr;
+    thread_cache *cache = local_cache();
+    if (cache != nullptr) {
+        free_list &local = cache->lists[cls];
+        if (local.head == nullptr) {
+            /* Refill a batch at once so the shared lock is taken rarely */
+            auto &sh = shared();
+            std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+            for (size_t i = 0; i < TP_BATCH && sh.lists[cls].head != nullptr; i++) {
+                local.push(sh.lists[cls].pop());
+            }
+        }
+        ptr = local.pop();
+    } else {
+        auto &sh = shared();
+        std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+        ptr = sh.lists[cls].pop();
+    }
+    if (ptr == nullptr) {
+        ptr = ::operator new(class_sizes[cls]);
+    }
+    return ptr;
+}
+
+void task_pool::deallocate(void *ptr, size_t size) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    size_t cls = class_of(size);
+    if (cls == class_count) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    thread_cache *cache = local_cache();
+    if (cache == nullptr) {
+        free_list single;
+        single.push(ptr);
+        give_back(cls, single, 1);
+        return;
+    }
+
+    free_list &local = cache->lists[cls];
+    local.push(ptr);
+    if (local.count > TP_CACHE_LIMIT) {
+        give_back(cls, local, TP_BATCH);
+    }
+}
+
+void task_pool::trim() {
+    auto &sh = shared();
+    for (size_t cls = 0; cls < class_count; cls++) {
+        std::lock_guard<std::mutex> lock(sh.mtx[cls]);
+        while (void *ptr = sh.lists[cls].pop()) {
+            ::operator delete(ptr);
+        }
+    }
+}
+
+} // namespace ipc::core
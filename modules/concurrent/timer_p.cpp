@@ -1,67 +1,192 @@
 #include "concurrent/timer.h"
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace ipc::core {
 class timer::timer_p {
-    friend class worker;
-    int m_interval = 0;
-    bool m_running = false;
-    timer::timeout_callback m_callback{nullptr};
-    std::shared_mutex m_mtx{};
-
-    timer_p(int ms) :
-        interval(m_interval),
-        m_state(0),
+    timer_p(const timer_p &) = delete;
+    timer_p &operator=(const timer_p &) = delete;
+
+    /* Shared with the armed callback, which may outlive the timer on the worker thread */
+    struct shared_state {
+        std::mutex mtx{};
+        std::condition_variable idle{};
+        timer::timeout_callback callback{nullptr};
+        std::atomic<uint64_t> expirations{0};
+        std::atomic<uint64_t> overrun{0};
+        std::atomic<bool> running{false};
+        bool cancelled = false;   ///< Set by stop(), a callback not yet entered is skipped
+        std::thread::id calling{}; ///< Thread running the callback, none when idle
+
+        void leave() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                calling = std::thread::id();
+            }
+            idle.notify_all();
+        }
+    };
+
+public:
+    timer_p(worker_ptr worker, std::chrono::microseconds interval, timer::Mode mode) :
+        m_worker(std::move(worker)),
+        m_interval(interval),
+        m_mode(mode),
+        m_state(std::make_shared<shared_state>()),
+        m_handle{},
         m_mtx{} {
     }
+
     ~timer_p() {
+        stop();
     }
 
     void set_callback(const timer::timeout_callback &callback) {
         std::lock_guard<std::mutex> lock(m_mtx);
-        m_callback = callback;
+        std::lock_guard<std::mutex> state_lock(m_state->mtx);
+        m_state->callback = callback;
     }
 
-    void set_interval(int ms) {
+    void set_interval(std::chrono::microseconds interval) {
         std::lock_guard<std::mutex> lock(m_mtx);
-        m_interval = ms;
+        m_interval = interval;
+    }
+
+    void set_mode(timer::Mode mode) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_mode = mode;
     }
 
     bool is_running() const {
-        std::shared_lock<std::shared_mutex> lock(m_mtx);
-        return m_running;
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_state->running.load();
     }
 
     void start() {
         std::lock_guard<std::mutex> lock(m_mtx);
-        m_running = true;
+        m_handle.cancel();
+        if (m_worker == nullptr) {
+            return;
+        }
+
+        /* A fresh state per start, a callback of the previous run cannot touch the new one */
+        auto state = std::make_shared<shared_state>();
+        {
+            std::lock_guard<std::mutex> state_lock(m_state->mtx);
+            state->callback = m_state->callback;
+        }
+        m_state->running.store(false);
+        state->running.store(true);
+        m_state = state;
+
+        bool periodic = (m_mode == timer::Periodic && m_interval > std::chrono::microseconds(0));
+        auto period = (periodic ? std::chrono::steady_clock::duration(m_interval) : std::chrono::steady_clock::duration::zero());
+        m_handle = m_worker->post_at(std::chrono::steady_clock::now() + m_interval, period, [state, periodic](uint64_t expirations) {
+            state->expirations.fetch_add(expirations);
+            state->overrun.store(expirations - 1U);
+            if (!periodic) {
+                state->running.store(false);
+            }
+            timer::timeout_callback callback{nullptr};
+            {
+                std::lock_guard<std::mutex> lock(state->mtx);
+                if (state->cancelled || state->callback == nullptr) {
+                    return;
+                }
+                callback = state->callback;
+                state->calling = std::this_thread::get_id();
+            }
+            try {
+                callback();
+            } catch (...) {
+                state->leave();
+                throw;
+            }
+            state->leave();
+        });
     }
 
+    /* Waits for a callback in progress, unless called from it */
     void stop() {
+        std::shared_ptr<shared_state> state = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_handle.cancel();
+            m_state->running.store(false);
+            state = m_state;
+        }
+        std::unique_lock<std::mutex> lock(state->mtx);
+        state->cancelled = true;
+        state->idle.wait(lock, [&state] {
+            return (state->calling == std::thread::id() || state->calling == std::this_thread::get_id());
+        });
+    }
+
+    uint64_t expirations() const {
         std::lock_guard<std::mutex> lock(m_mtx);
-        m_running = false;
+        return m_state->expirations.load();
     }
+
+    uint64_t overrun() const {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_state->overrun.load();
+    }
+
+private:
+    worker_ptr m_worker = nullptr;
+    std::chrono::microseconds m_interval = std::chrono::microseconds(0);
+    timer::Mode m_mode = timer::Periodic;
+    std::shared_ptr<shared_state> m_state = nullptr;
+    worker::timer_handle m_handle = {};
+    mutable std::mutex m_mtx = {};
 };
 
-timer::timer(int ms) :
-    m_impl(std::unique_ptr<timer_p>(new timer_p(ms))) {
+timer::timer(worker_ptr worker, std::chrono::microseconds interval, Mode mode) :
+    m_impl(std::make_unique<timer_p>(std::move(worker), interval, mode)) {
 }
+
+timer::timer(evloop_ptr loop, std::chrono::microseconds interval, Mode mode) :
+    m_impl(std::make_unique<timer_p>(loop != nullptr ? loop->worker() : nullptr, interval, mode)) {
+}
+
 timer::~timer() {
 }
 
 void timer::set_callback(const timeout_callback &callback) {
     m_impl->set_callback(callback);
 }
+
 void timer::set_interval(int ms) {
-    m_impl->set_interval(ms);
+    m_impl->set_interval(std::chrono::milliseconds(ms));
+}
+
+void timer::set_interval(std::chrono::microseconds interval) {
+    m_impl->set_interval(interval);
+}
+
+void timer::set_mode(Mode mode) {
+    m_impl->set_mode(mode);
 }
+
 bool timer::is_running() const {
     return m_impl->is_running();
 }
+
 void timer::start() {
     m_impl->start();
 }
+
 void timer::stop() {
     m_impl->stop();
 }
-} // namespace ipc::core
\ No newline at end of file
+
+uint64_t timer::expirations() const {
+    return m_impl->expirations();
+}
+
+uint64_t timer::overrun() const {
+    return m_impl->overrun();
+}
+} // namespace ipc::core
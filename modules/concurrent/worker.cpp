@@ -50,6 +50,10 @@ size_t worker::task_count() const {
     return m_impl->task_count();
 }
 
+worker::batch_stats worker::stats() const {
+    return m_impl->stats();
+}
+
 void worker::assign_to(int cpu) {
     m_impl->assign_to(cpu);
 }
@@ -58,10 +62,38 @@ void worker::add_task(task_base_ptr task) {
     m_impl->add_task(task);
 }
 
+void worker::add_task(task_base_ptr task, Priority priority) {
+    m_impl->add_task(std::move(task), priority);
+}
+
+void worker::add_task(task_base_ptr task, std::chrono::steady_clock::time_point deadline) {
+    m_impl->add_task(std::move(task), deadline);
+}
+
 void worker::add_weak_task(task_base_weak_ptr task) {
     m_impl->add_weak_task(task);
 }
 
+worker::timer_handle worker::post_after(std::chrono::steady_clock::duration delay, std::function<void()> func) {
+    return post_at(std::chrono::steady_clock::now() + delay, std::chrono::steady_clock::duration::zero(),
+                   [func = std::move(func)](uint64_t) { func(); });
+}
+
+worker::timer_handle worker::post_every(std::chrono::steady_clock::duration period, std::function<void()> func) {
+    if (period <= std::chrono::steady_clock::duration::zero()) {
+        return timer_handle();
+    }
+    return post_at(std::chrono::steady_clock::now() + period, period, [func = std::move(func)](uint64_t) { func(); });
+}
+
+worker::timer_handle worker::post_at(std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration period,
+                                     std::function<void(uint64_t)> func) {
+    timer_handle handle;
+    handle.m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_impl->add_timer(deadline, period, std::move(func), handle.m_cancelled);
+    return handle;
+}
+
 void worker::reset() {
     m_impl->reset();
 }
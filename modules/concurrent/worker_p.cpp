@@ -1,5 +1,7 @@
 #include "worker_p.h"
 
+#include <algorithm>
+
 #ifdef __linux__
 #include <pthread.h>
 #include <unistd.h>
@@ -7,45 +9,74 @@
 
 namespace ipc::core {
 
-static constexpr int WK_WAIT_TIMEOUT = 10000;
+/* Most tasks moved from the queue to the lanes by one take_batch() call */
+static constexpr size_t WK_BATCH_SIZE = 256;
+/* A deadline this close is treated as due and runs ahead of the High lane */
+static constexpr std::chrono::microseconds WK_DEADLINE_SLACK{1000};
 
 worker::impl::impl(const std::vector<task_base_ptr> &task_list, int id) :
     m_id(id),
     m_state(worker::Idle),
     m_task_queue{},
+    m_task_count(0),
+    m_parked(false),
+    m_reset(false),
     m_task_queue_mtx{},
     m_condition{},
     m_joined(false),
     m_executed_count(0),
+    m_batch_count(0),
+    m_batch_tasks(0),
+    m_last_batch(0),
+    m_max_batch(0),
+    m_late_count(0),
+    m_lanes{},
+    m_deadlines{},
+    m_seq(0),
+    m_timers{},
+    m_sorted_count(0),
     m_worker_thread(std::thread(&impl::run, this)) {
     for (auto task : task_list) {
-        m_task_queue.emplace(std::move(task), task_base_weak_ptr{});
+        add_task(std::move(task));
     }
 }
 
-worker::impl::~impl() {}
+worker::impl::~impl() {
+    /* Tasks never run, e.g. queued after quit() */
+    while (task_node *node = m_task_queue.pop()) {
+        delete node;
+    }
+    while (task_node *node = next_task()) {
+        delete node;
+    }
+}
 
 int worker::impl::id() const {
     return m_id;
 }
 
 int worker::impl::state() const {
-    std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-    return static_cast<int>(m_state);
+    return static_cast<int>(m_state.load());
 }
 
 void worker::impl::start() {
-    std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-    if (m_state != worker::Exited) {
-        m_state = worker::Running;
-    }
+    set_state(worker::Running);
 }
 
 void worker::impl::stop() {
-    std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-    if (m_state != worker::Exited) {
-        m_state = worker::Stopped;
+    set_state(worker::Stopped);
+}
+
+/* Every state change is signalled, the worker thread never polls for one */
+void worker::impl::set_state(worker::State state) {
+    {
+        std::unique_lock<std::mutex> lock(m_task_queue_mtx);
+        if (m_state == worker::Exited || m_state == worker::Finalized || m_state == state) {
+            return;
+        }
+        m_state = state;
     }
+    m_condition.notify_all();
 }
 
 void worker::impl::join() {
@@ -68,13 +99,7 @@ void worker::impl::detach() {
 }
 
 void worker::impl::quit() {
-    {
-        std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-        if (m_state != worker::Exited) {
-            m_state = worker::Finalized;
-        }
-    }
-    m_condition.notify_all();
+    set_state(worker::Finalized);
 }
 
 size_t worker::impl::executed_count() const {
@@ -82,8 +107,17 @@ size_t worker::impl::executed_count() const {
 }
 
 size_t worker::impl::task_count() const {
-    std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-    return m_task_queue.size();
+    return m_task_count.load(std::memory_order_relaxed) + m_sorted_count.load(std::memory_order_relaxed);
+}
+
+worker::batch_stats worker::impl::stats() const {
+    worker::batch_stats stats;
+    stats.batches = m_batch_count.load(std::memory_order_relaxed);
+    stats.tasks = m_batch_tasks.load(std::memory_order_relaxed);
+    stats.last_size = m_last_batch.load(std::memory_order_relaxed);
+    stats.max_size = m_max_batch.load(std::memory_order_relaxed);
+    stats.late = m_late_count.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void worker::impl::assign_to(int cpu) {
@@ -113,73 +147,295 @@ void worker::impl::assign_to(int cpu) {
 #endif
 }
 
-void worker::impl::add_task(task_base_ptr task) {
-    std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-    if (m_state != worker::Exited) {
-        m_task_queue.emplace(std::move(task), task_base_weak_ptr{});
+void worker::impl::push(task_node *node) {
+    /* Counted before it is linked, a worker about to park sees it either way */
+    m_task_count.fetch_add(1U);
+    m_task_queue.push(node);
+    if (m_parked.load()) {
+        /* Taking the lock orders the notify after the worker started waiting */
+        { std::unique_lock<std::mutex> lock(m_task_queue_mtx); }
         m_condition.notify_one();
     }
 }
 
+void worker::impl::add_task(task_base_ptr task) {
+    if (m_state.load() != worker::Exited) {
+        task_node *node = new task_node();
+        node->task = std::move(task);
+        push(node);
+    }
+}
+
+void worker::impl::add_task(task_base_ptr task, worker::Priority priority) {
+    if (m_state.load() != worker::Exited) {
+        task_node *node = new task_node();
+        node->task = std::move(task);
+        node->priority = (priority >= worker::High && priority <= worker::Low ? priority : worker::Normal);
+        push(node);
+    }
+}
+
+void worker::impl::add_task(task_base_ptr task, std::chrono::steady_clock::time_point deadline) {
+    if (m_state.load() != worker::Exited) {
+        task_node *node = new task_node();
+        node->task = std::move(task);
+        node->deadline = deadline;
+        node->has_deadline = true;
+        push(node);
+    }
+}
+
 void worker::impl::add_weak_task(task_base_weak_ptr task) {
-    std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-    if (m_state != worker::Exited) {
-        m_task_queue.emplace(task_base_ptr{nullptr}, std::move(task));
-        m_condition.notify_one();
+    if (m_state.load() != worker::Exited) {
+        task_node *node = new task_node();
+        node->weak_task = std::move(task);
+        push(node);
+    }
+}
+
+void worker::impl::add_timer(std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration period,
+                             std::function<void(uint64_t)> func, std::shared_ptr<std::atomic<bool>> cancelled) {
+    if (m_state.load() != worker::Exited) {
+        task_node *node = new task_node();
+        node->timer = std::make_unique<timer_entry>();
+        node->timer->due = deadline;
+        node->timer->period = period;
+        node->timer->func = std::move(func);
+        node->timer->cancelled = std::move(cancelled);
+        push(node);
     }
 }
 
 void worker::impl::reset() {
-    std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-    if (m_state != worker::Exited) {
-        m_task_queue = {};
+    /* Only the worker thread may pop, it drops the queued tasks on its next turn */
+    if (m_state.load() != worker::Exited) {
+        {
+            std::unique_lock<std::mutex> lock(m_task_queue_mtx);
+            m_reset.store(true);
+        }
+        m_condition.notify_one();
+    }
+}
+
+void worker::impl::drop_queued() {
+    while (m_task_count.load() > 0) {
+        task_node *node = m_task_queue.pop();
+        if (node == nullptr) {
+            /* A producer is between counting and linking its node */
+            std::this_thread::yield();
+            continue;
+        }
+        m_task_count.fetch_sub(1U);
+        delete node;
     }
+    while (task_node *node = next_task()) {
+        delete node;
+    }
+    m_timers.clear();
 }
 
 std::thread::id worker::impl::thread_id() const {
     return m_worker_thread.get_id();
 }
 
+/* Move up to max queued nodes to the lanes and the deadline heap */
+size_t worker::impl::take_batch(size_t max) {
+    size_t count = 0;
+    size_t timers = 0;
+    while (count < max) {
+        task_node *node = m_task_queue.pop();
+        if (node == nullptr) {
+            /* Empty, or a producer is still linking its node */
+            break;
+        }
+        node->seq = m_seq++;
+        if (node->timer != nullptr) {
+            node->timer->seq = node->seq;
+            m_timers.push_back(std::move(node->timer));
+            std::push_heap(m_timers.begin(), m_timers.end(), later_due());
+            delete node;
+            timers++;
+        } else if (node->has_deadline) {
+            m_deadlines.push_back(node);
+            std::push_heap(m_deadlines.begin(), m_deadlines.end(), later_deadline());
+        } else {
+            m_lanes[node->priority].push_back(node);
+        }
+        count++;
+    }
+    if (count > 0) {
+        m_sorted_count.fetch_add(count - timers);
+        m_task_count.fetch_sub(count);
+
+        size_t max_batch = m_max_batch.load(std::memory_order_relaxed);
+        m_batch_count.store(m_batch_count.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+        m_batch_tasks.store(m_batch_tasks.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        m_last_batch.store(count, std::memory_order_relaxed);
+        if (count > max_batch) {
+            m_max_batch.store(count, std::memory_order_relaxed);
+        }
+    }
+    return count;
+}
+
+/*
+ * Due deadlines, then High, then the other deadlines earliest first, then Normal and Low.
+ * A deadline only preempts High once it is due, so a stream of deadline tasks with
+ * slack cannot starve the High lane.
+ */
+worker::impl::task_node *worker::impl::next_task() {
+    task_node *node = nullptr;
+    auto &high = m_lanes[worker::High];
+    bool deadline_first = !m_deadlines.empty();
+    if (deadline_first && !high.empty()) {
+        deadline_first = (m_deadlines.front()->deadline <= std::chrono::steady_clock::now() + WK_DEADLINE_SLACK);
+    }
+    if (deadline_first) {
+        std::pop_heap(m_deadlines.begin(), m_deadlines.end(), later_deadline());
+        node = m_deadlines.back();
+        m_deadlines.pop_back();
+    } else if (!high.empty()) {
+        node = high.front();
+        high.pop_front();
+    } else {
+        for (auto &lane : m_lanes) {
+            if (!lane.empty()) {
+                node = lane.front();
+                lane.pop_front();
+                break;
+            }
+        }
+    }
+    if (node != nullptr) {
+        m_sorted_count.fetch_sub(1U);
+    }
+    return node;
+}
+
+bool worker::impl::run_task(task_node *node) {
+    task_base_ptr _task = {nullptr};
+    if (node->task != nullptr) {
+        _task = std::move(node->task);
+    } else {
+        _task = node->weak_task.lock();
+    }
+    if (node->has_deadline && std::chrono::steady_clock::now() > node->deadline) {
+        m_late_count.store(m_late_count.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+    }
+    delete node;
+
+    if (_task != nullptr) {
+        _task->execute();
+        return true;
+    }
+    return false;
+}
+
+/* Run the due timers and rearm the periodic ones on their grid */
+void worker::impl::run_timers() {
+    auto now = std::chrono::steady_clock::now();
+    while (!m_timers.empty() && m_timers.front()->due <= now) {
+        std::pop_heap(m_timers.begin(), m_timers.end(), later_due());
+        std::unique_ptr<timer_entry> entry = std::move(m_timers.back());
+        m_timers.pop_back();
+        if (entry->cancelled->load()) {
+            continue;
+        }
+
+        /* Expirations passed meanwhile are folded into this run */
+        uint64_t expirations = 1;
+        bool periodic = (entry->period > std::chrono::steady_clock::duration::zero());
+        if (periodic) {
+            expirations += static_cast<uint64_t>((now - entry->due) / entry->period);
+            entry->due += entry->period * static_cast<std::chrono::steady_clock::duration::rep>(expirations);
+        }
+        try {
+            entry->func(expirations);
+        } catch (...) {
+            // Do nothing
+        }
+        if (periodic && !entry->cancelled->load()) {
+            entry->seq = m_seq++;
+            m_timers.push_back(std::move(entry));
+            std::push_heap(m_timers.begin(), m_timers.end(), later_due());
+        }
+    }
+}
+
 void worker::impl::run() {
-    using namespace std::chrono_literals;
     do {
-        task_base_ptr _task = {nullptr};
         try {
-            {
+            if (m_reset.exchange(false)) {
+                drop_queued();
+            }
+            worker::State state = m_state.load();
+            if (state == worker::Finalized) {
+                break;
+            } else if (state != worker::Running) {
+                /* Idle or stopped, sleep until start(), quit() or reset() */
                 std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-                if (m_task_queue.size() == 0) {
-                    m_condition.wait_for(lock, std::chrono::milliseconds(1000), [this] {
-                        return ((m_state != worker::Running) || (m_task_queue.empty() == false));
-                    });
+                m_condition.wait(lock, [this] {
+                    worker::State s = m_state.load();
+                    return ((s == worker::Running) || (s == worker::Finalized) || m_reset.load());
+                });
+                continue;
+            }
+
+            take_batch(WK_BATCH_SIZE);
+            if (!m_timers.empty()) {
+                run_timers();
+            }
+            if (m_sorted_count.load(std::memory_order_relaxed) == 0) {
+                if (m_task_count.load() > 0) {
+                    /* A producer is between counting and linking its node */
+                    std::this_thread::yield();
+                    continue;
                 }
-                if (m_state == worker::Finalized) {
-                    break;
-                } else if (m_state == worker::Running) {
-                    if (m_task_queue.size() > 0) {
-                        std::pair<task_base_ptr, task_base_weak_ptr> p = std::move(m_task_queue.front());
-                        if (p.first != nullptr) {
-                            _task = p.first;
-                        } else {
-                            _task = p.second.lock();
-                        }
-                        m_task_queue.pop();
-                    }
+                /* Producers see m_parked and notify, state changes always notify, only a timer times out */
+                std::unique_lock<std::mutex> lock(m_task_queue_mtx);
+                m_parked.store(true);
+                auto wake = [this] {
+                    return ((m_state.load() != worker::Running) || (m_task_count.load() > 0) || m_reset.load());
+                };
+                if (m_timers.empty()) {
+                    m_condition.wait(lock, wake);
                 } else {
-                    std::this_thread::sleep_for(1ms);
+                    m_condition.wait_until(lock, m_timers.front()->due, wake);
                 }
+                m_parked.store(false);
+                continue;
             }
 
-            if (_task != nullptr) {
-                _task->execute();
-                m_executed_count.fetch_add(1U);
+            /*
+             * Run the sorted tasks, stop(), quit() and reset() are seen after every one. Tasks
+             * queued meanwhile are sorted in before the next pick, so a High task or a deadline
+             * does not wait behind the bulk work taken earlier.
+             */
+            while (task_node *node = next_task()) {
+                try {
+                    if (run_task(node)) {
+                        m_executed_count.fetch_add(1U, std::memory_order_relaxed);
+                    }
+                } catch (...) {
+                    // Do nothing
+                }
+                if (m_state.load() != worker::Running || m_reset.load()) {
+                    break;
+                }
+                if (m_task_count.load(std::memory_order_relaxed) > 0) {
+                    take_batch(WK_BATCH_SIZE);
+                }
+                if (!m_timers.empty()) {
+                    run_timers();
+                }
             }
         } catch (...) {
             // Do nothing
         }
-    } while (m_state != worker::Finalized);
+    } while (m_state.load() != worker::Finalized);
     {
         std::unique_lock<std::mutex> lock(m_task_queue_mtx);
-        m_state = worker::Exited;
+        m_state.store(worker::Exited);
     }
 }
 
@@ -1,14 +1,17 @@
 #ifndef WORKER_P_H
 #define WORKER_P_H
 
-#include <queue>
 #include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
 #include "concurrent/worker.h"
+#include "mpsc_queue_p.h"
 
 namespace ipc::core {
 class worker::impl {
@@ -30,22 +33,87 @@ public:
     void detach();
     size_t executed_count() const;
     size_t task_count() const;
+    worker::batch_stats stats() const;
     void assign_to(int cpu);
     void add_task(task_base_ptr task);
+    void add_task(task_base_ptr task, worker::Priority priority);
+    void add_task(task_base_ptr task, std::chrono::steady_clock::time_point deadline);
     void add_weak_task(task_base_weak_ptr task);
+    void add_timer(std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration period,
+                   std::function<void(uint64_t)> func, std::shared_ptr<std::atomic<bool>> cancelled);
     void reset();
     std::thread::id thread_id() const;
 
 private:
+    /* Delayed or periodic function, owned by the worker thread once queued */
+    struct timer_entry {
+        std::chrono::steady_clock::time_point due{};
+        std::chrono::steady_clock::duration period{};
+        uint64_t seq = 0;
+        std::function<void(uint64_t)> func{nullptr};
+        std::shared_ptr<std::atomic<bool>> cancelled{nullptr};
+    };
+
+    /* Orders the timer heap, earliest due on top, FIFO among equal ones */
+    struct later_due {
+        bool operator()(const std::unique_ptr<timer_entry> &a, const std::unique_ptr<timer_entry> &b) const {
+            return (a->due != b->due ? a->due > b->due : a->seq > b->seq);
+        }
+    };
+
+    /* Queued task, either owned or weakly referenced, or a timer on its way to the heap */
+    struct task_node {
+        std::atomic<task_node *> next{nullptr};
+        task_base_ptr task{nullptr};
+        task_base_weak_ptr weak_task{};
+        std::unique_ptr<timer_entry> timer{nullptr};
+        std::chrono::steady_clock::time_point deadline{};
+        uint64_t seq = 0;
+        int priority = worker::Normal;
+        bool has_deadline = false;
+    };
+
+    /* Orders the deadline heap, earliest deadline on top, FIFO among equal ones */
+    struct later_deadline {
+        bool operator()(const task_node *a, const task_node *b) const {
+            return (a->deadline != b->deadline ? a->deadline > b->deadline : a->seq > b->seq);
+        }
+    };
+
     void run();
+    void set_state(worker::State state);
+    void push(task_node *node);
+    void drop_queued();
+    size_t take_batch(size_t max);
+    task_node *next_task();
+    bool run_task(task_node *node);
+    void run_timers();
 
     int m_id = 0;
-    worker::State m_state = worker::Idle;
-    std::queue<std::pair<task_base_ptr, task_base_weak_ptr>> m_task_queue = {};
+    std::atomic<worker::State> m_state = {worker::Idle};
+    mpsc_queue<task_node> m_task_queue = {};
+    /* Pushed but not yet popped, also covers nodes a producer is still linking */
+    std::atomic<size_t> m_task_count = {0};
+    /* Set while the worker thread waits, producers only notify a parked worker */
+    std::atomic<bool> m_parked = {false};
+    std::atomic<bool> m_reset = {false};
+    /* Guards the condition variable and state changes, not the queue */
     mutable std::mutex m_task_queue_mtx = {};
     std::condition_variable m_condition = {};
     bool m_joined = false;
     std::atomic<size_t> m_executed_count = {0};
+    /* Only written by the worker thread */
+    std::atomic<size_t> m_batch_count = {0};
+    std::atomic<size_t> m_batch_tasks = {0};
+    std::atomic<size_t> m_last_batch = {0};
+    std::atomic<size_t> m_max_batch = {0};
+    std::atomic<size_t> m_late_count = {0};
+    /* Taken from the queue and sorted, only touched by the worker thread */
+    std::deque<task_node *> m_lanes[worker::Low + 1] = {};
+    std::vector<task_node *> m_deadlines = {};
+    uint64_t m_seq = 0;
+    std::vector<std::unique_ptr<timer_entry>> m_timers = {};
+    std::atomic<size_t> m_sorted_count = {0};
     std::thread m_worker_thread = {};
 };
 
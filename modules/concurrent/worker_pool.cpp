@@ -0,0 +1,70 @@
+#include "worker_pool_p.h"
+
+namespace ipc::core {
+
+/**
+ * @fn worker_pool::worker_pool(size_t count)
+ * @brief Construct a new worker_pool object, the threads wait for start()
+ *
+ */
+worker_pool::worker_pool(size_t count) :
+    m_impl(std::make_unique<worker_pool::impl>(count)) {
+}
+
+worker_pool::~worker_pool() {
+}
+
+size_t worker_pool::size() const {
+    return m_impl->size();
+}
+
+int worker_pool::state() const {
+    return m_impl->state();
+}
+
+void worker_pool::start() {
+    m_impl->start();
+}
+
+void worker_pool::stop() {
+    m_impl->stop();
+}
+
+void worker_pool::quit() {
+    m_impl->quit();
+}
+
+void worker_pool::join() {
+    m_impl->join();
+}
+
+size_t worker_pool::executed_count() const {
+    return m_impl->executed_count();
+}
+
+size_t worker_pool::task_count() const {
+    return m_impl->task_count();
+}
+
+size_t worker_pool::stolen_count() const {
+    return m_impl->stolen_count();
+}
+
+void worker_pool::assign_to(size_t index, int cpu) {
+    m_impl->assign_to(index, cpu);
+}
+
+void worker_pool::assign_to(int first_cpu) {
+    for (size_t i = 0; i < m_impl->size(); i++) {
+        m_impl->assign_to(i, first_cpu + static_cast<int>(i));
+    }
+}
+
+void worker_pool::add_task(task_base_ptr task) {
+    m_impl->add_task(std::move(task));
+}
+
+void worker_pool::add_weak_task(task_base_weak_ptr task) {
+    m_impl->add_weak_task(std::move(task));
+}
+} // namespace ipc::core
@@ -0,0 +1,332 @@
+#include "worker_pool_p.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace ipc::core {
+
+/* Most tasks moved from the injection queue to the stealable deque at once */
+static constexpr size_t WP_INJECT_BATCH = 32;
+
+/* Pool and slot of the calling thread, if it is a pool thread */
+static thread_local const void *t_pool = nullptr;
+static thread_local size_t t_slot = 0;
+
+static inline uint64_t wp_next_random(uint64_t &seed) {
+    /* xorshift64 */
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+worker_pool::impl::impl(size_t count) :
+    m_slots{},
+    m_state(worker::Idle),
+    m_next_slot(0),
+    m_executed_count(0),
+    m_stolen_count(0),
+    m_join_mtx{},
+    m_joined(false) {
+    if (count == 0) {
+        count = std::thread::hardware_concurrency();
+    }
+    if (count == 0) {
+        count = 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        m_slots.push_back(std::make_unique<slot>());
+        m_slots.back()->index = i;
+        m_slots.back()->seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+    /* Threads start after all slots exist, they steal from each other */
+    for (auto &s : m_slots) {
+        s->thread = std::thread(&impl::run, this, std::ref(*s));
+    }
+}
+
+worker_pool::impl::~impl() {
+    quit();
+    join();
+    for (auto &s : m_slots) {
+        while (task_node *node = s->deque.pop()) {
+            delete node;
+        }
+        while (task_node *node = s->inject.pop()) {
+            delete node;
+        }
+    }
+}
+
+size_t worker_pool::impl::size() const {
+    return m_slots.size();
+}
+
+int worker_pool::impl::state() const {
+    return static_cast<int>(m_state.load());
+}
+
+void worker_pool::impl::notify_all() {
+    for (auto &s : m_slots) {
+        {
+            std::unique_lock<std::mutex> lock(s->mtx);
+        }
+        s->condition.notify_all();
+    }
+}
+
+void worker_pool::impl::start() {
+    worker::State state = m_state.load();
+    while (state == worker::Idle || state == worker::Stopped) {
+        if (m_state.compare_exchange_weak(state, worker::Running)) {
+            notify_all();
+            break;
+        }
+    }
+}
+
+void worker_pool::impl::stop() {
+    worker::State state = m_state.load();
+    while (state == worker::Idle || state == worker::Running) {
+        if (m_state.compare_exchange_weak(state, worker::Stopped)) {
+            break;
+        }
+    }
+}
+
+void worker_pool::impl::quit() {
+    worker::State state = m_state.load();
+    while (state != worker::Finalized && state != worker::Exited) {
+        if (m_state.compare_exchange_weak(state, worker::Finalized)) {
+            notify_all();
+            break;
+        }
+    }
+}
+
+void worker_pool::impl::join() {
+    std::unique_lock<std::mutex> lock(m_join_mtx);
+    if (m_joined == false) {
+        m_joined = true;
+        for (auto &s : m_slots) {
+            if (s->thread.joinable() == true && s->thread.get_id() != std::this_thread::get_id()) {
+                s->thread.join();
+            }
+        }
+        m_state.store(worker::Exited);
+    }
+}
+
+size_t worker_pool::impl::executed_count() const {
+    return m_executed_count.load();
+}
+
+size_t worker_pool::impl::task_count() const {
+    size_t count = 0;
+    for (auto &s : m_slots) {
+        count += s->inject_count.load() + s->deque.size();
+    }
+    return count;
+}
+
+size_t worker_pool::impl::stolen_count() const {
+    return m_stolen_count.load();
+}
+
+void worker_pool::impl::assign_to(size_t index, int cpu) {
+#ifdef __linux__
+    if (index < m_slots.size() && cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        int ret = pthread_setaffinity_np(m_slots[index]->thread.native_handle(), sizeof(cpuset), &cpuset);
+        if (ret != 0) {
+            fprintf(stderr, "[%s] pthread_setaffinity_np failed, %d\n", __FUNCTION__, ret);
+        }
+    }
+#endif
+}
+
+void worker_pool::impl::add_task(task_base_ptr task) {
+    if (m_state.load() != worker::Exited) {
+        task_node *node = new task_node();
+        node->task = std::move(task);
+        push(node);
+    }
+}
+
+void worker_pool::impl::add_weak_task(task_base_weak_ptr task) {
+    if (m_state.load() != worker::Exited) {
+        task_node *node = new task_node();
+        node->weak_task = std::move(task);
+        push(node);
+    }
+}
+
+void worker_pool::impl::wake(slot &target) {
+    {
+        std::unique_lock<std::mutex> lock(target.mtx);
+    }
+    target.condition.notify_one();
+}
+
+/* Wake one sleeping thread other than except to steal, no-op if none sleeps */
+void worker_pool::impl::wake_parked(size_t except) {
+    size_t count = m_slots.size();
+    size_t first = m_next_slot.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        slot &s = *m_slots[(first + i) % count];
+        if (s.index != except && s.parked.load()) {
+            wake(s);
+            return;
+        }
+    }
+}
+
+void worker_pool::impl::push(task_node *node) {
+    if (t_pool == this) {
+        /* Spawned by a task of this pool, keep it local and let a sleeping thread steal it */
+        m_slots[t_slot]->deque.push(node);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake_parked(t_slot);
+        return;
+    }
+
+    /* Prefer a sleeping thread, otherwise deal round-robin */
+    size_t count = m_slots.size();
+    size_t first = m_next_slot.fetch_add(1U, std::memory_order_relaxed);
+    slot *target = m_slots[first % count].get();
+    for (size_t i = 0; i < count; i++) {
+        slot *s = m_slots[(first + i) % count].get();
+        if (s->parked.load(std::memory_order_relaxed)) {
+            target = s;
+            break;
+        }
+    }
+    target->inject_count.fetch_add(1U);
+    target->inject.push(node);
+    if (target->parked.load()) {
+        wake(*target);
+    }
+}
+
+bool worker_pool::impl::has_work(const slot &self) const {
+    if (self.inject_count.load() > 0) {
+        return true;
+    }
+    for (auto &s : m_slots) {
+        if (!s->deque.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Move a batch from the injection queue to the deque, so other threads can steal it */
+worker_pool::impl::task_node *worker_pool::impl::take_injected(slot &self) {
+    task_node *first = nullptr;
+    size_t moved = 0;
+    for (size_t i = 0; i < WP_INJECT_BATCH; i++) {
+        task_node *node = self.inject.pop();
+        if (node == nullptr) {
+            break;
+        }
+        self.inject_count.fetch_sub(1U);
+        if (first == nullptr) {
+            first = node;
+        } else {
+            self.deque.push(node);
+            moved++;
+        }
+    }
+    if (moved > 0) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake_parked(self.index);
+    }
+    return first;
+}
+
+worker_pool::impl::task_node *worker_pool::impl::next_task(slot &self) {
+    task_node *node = self.deque.pop();
+    if (node != nullptr) {
+        return node;
+    }
+    node = take_injected(self);
+    if (node != nullptr) {
+        return node;
+    }
+
+    /* Random victims, one round over the pool */
+    size_t count = m_slots.size();
+    for (size_t i = 0; i < count; i++) {
+        slot &victim = *m_slots[wp_next_random(self.seed) % count];
+        if (victim.index == self.index) {
+            continue;
+        }
+        node = victim.deque.steal();
+        if (node != nullptr) {
+            m_stolen_count.fetch_add(1U, std::memory_order_relaxed);
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+void worker_pool::impl::run(slot &self) {
+    t_pool = this;
+    t_slot = self.index;
+
+    while (true) {
+        worker::State state = m_state.load();
+        if (state == worker::Finalized || state == worker::Exited) {
+            break;
+        }
+        if (state != worker::Running) {
+            std::unique_lock<std::mutex> lock(self.mtx);
+            self.condition.wait(lock, [this] {
+                worker::State s = m_state.load();
+                return (s != worker::Idle && s != worker::Stopped);
+            });
+            continue;
+        }
+
+        task_node *node = next_task(self);
+        if (node == nullptr) {
+            std::unique_lock<std::mutex> lock(self.mtx);
+            self.parked.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (has_work(self)) {
+                /* Lost a steal race or a producer is still linking its node */
+                self.parked.store(false);
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            self.condition.wait(lock, [this, &self] {
+                return (m_state.load() != worker::Running || has_work(self));
+            });
+            self.parked.store(false);
+            continue;
+        }
+
+        task_base_ptr _task = {nullptr};
+        if (node->task != nullptr) {
+            _task = std::move(node->task);
+        } else {
+            _task = node->weak_task.lock();
+        }
+        delete node;
+        try {
+            if (_task != nullptr) {
+                _task->execute();
+                m_executed_count.fetch_add(1U);
+            }
+        } catch (...) {
+            // Do nothing
+        }
+    }
+    t_pool = nullptr;
+}
+
+} // namespace ipc::core
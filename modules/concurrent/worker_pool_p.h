@@ -0,0 +1,77 @@
+#ifndef WORKER_POOL_P_H
+#define WORKER_POOL_P_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "concurrent/worker_pool.h"
+#include "mpsc_queue_p.h"
+#include "ws_deque_p.h"
+
+namespace ipc::core {
+class worker_pool::impl {
+    impl(const impl &) = delete;
+    impl(impl &&) = delete;
+    impl &operator=(const impl &) = delete;
+
+public:
+    explicit impl(size_t count);
+    virtual ~impl();
+
+    size_t size() const;
+    int state() const;
+    void start();
+    void stop();
+    void quit();
+    void join();
+    size_t executed_count() const;
+    size_t task_count() const;
+    size_t stolen_count() const;
+    void assign_to(size_t index, int cpu);
+    void add_task(task_base_ptr task);
+    void add_weak_task(task_base_weak_ptr task);
+
+private:
+    struct task_node {
+        std::atomic<task_node *> next{nullptr};
+        task_base_ptr task{nullptr};
+        task_base_weak_ptr weak_task{};
+    };
+
+    /* Per thread state, tasks from outside the pool arrive through the injection queue */
+    struct slot {
+        size_t index = 0;
+        ws_deque<task_node> deque{};
+        mpsc_queue<task_node> inject{};
+        std::atomic<size_t> inject_count{0};
+        std::atomic<bool> parked{false};
+        std::mutex mtx{};
+        std::condition_variable condition{};
+        uint64_t seed = 0;
+        std::thread thread{};
+    };
+
+    void run(slot &self);
+    task_node *next_task(slot &self);
+    task_node *take_injected(slot &self);
+    bool has_work(const slot &self) const;
+    void push(task_node *node);
+    void wake(slot &target);
+    void wake_parked(size_t except);
+    void notify_all();
+
+    std::vector<std::unique_ptr<slot>> m_slots = {};
+    std::atomic<worker::State> m_state = {worker::Idle};
+    std::atomic<size_t> m_next_slot = {0};
+    std::atomic<size_t> m_executed_count = {0};
+    std::atomic<size_t> m_stolen_count = {0};
+    std::mutex m_join_mtx = {};
+    bool m_joined = false;
+};
+
+} // namespace ipc::core
+
+#endif // WORKER_POOL_P_H
@@ -0,0 +1,137 @@
+#ifndef WS_DEQUE_P_H
+#define WS_DEQUE_P_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace ipc::core {
+
+/**
+ * @class ws_deque
+ * @brief Chase-Lev work-stealing deque of pointers
+ *
+ * The owner thread pushes and pops at the bottom, any other thread may steal from
+ * the top. The ring grows when full, replaced rings are kept until destruction since
+ * a thief may still read from them.
+ */
+template <typename T>
+class ws_deque {
+    ws_deque(const ws_deque &) = delete;
+    ws_deque &operator=(const ws_deque &) = delete;
+
+    struct ring {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T *>[]> slots;
+
+        explicit ring(int64_t cap) :
+            capacity(cap),
+            slots(new std::atomic<T *>[static_cast<size_t>(cap)]) {
+        }
+        T *get(int64_t index) const {
+            return slots[static_cast<size_t>(index & (capacity - 1))].load(std::memory_order_relaxed);
+        }
+        void put(int64_t index, T *item) {
+            slots[static_cast<size_t>(index & (capacity - 1))].store(item, std::memory_order_relaxed);
+        }
+    };
+
+public:
+    /**
+     * @param capacity  Initial capacity, rounded up to a power of two
+     */
+    explicit ws_deque(int64_t capacity = 256) :
+        m_top(0),
+        m_bottom(0),
+        m_ring(nullptr),
+        m_rings{} {
+        int64_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        m_rings.push_back(std::make_unique<ring>(cap));
+        m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    /* Owner only */
+    void push(T *item) {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_acquire);
+        ring *r = m_ring.load(std::memory_order_relaxed);
+        if (b - t > r->capacity - 1) {
+            r = grow(r, b, t);
+        }
+        r->put(b, item);
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    /* Owner only, nullptr when empty */
+    T *pop() {
+        int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        ring *r = m_ring.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        if (t > b) {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T *item = r->get(b);
+        if (t == b) {
+            /* Last item, race the thieves for it */
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /* Any thread, nullptr when empty or when another thread won the race */
+    T *steal() {
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        ring *r = m_ring.load(std::memory_order_acquire);
+        T *item = r->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    /* Approximate when called by a thief */
+    size_t size() const {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        return (b > t ? static_cast<size_t>(b - t) : 0);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    ring *grow(ring *old, int64_t b, int64_t t) {
+        m_rings.push_back(std::make_unique<ring>(old->capacity * 2));
+        ring *r = m_rings.back().get();
+        for (int64_t i = t; i < b; i++) {
+            r->put(i, old->get(i));
+        }
+        m_ring.store(r, std::memory_order_release);
+        return r;
+    }
+
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+    std::atomic<ring *> m_ring;
+    std::vector<std::unique_ptr<ring>> m_rings;
+};
+
+} // namespace ipc::core
+
+#endif // WS_DEQUE_P_H
@@ -0,0 +1,282 @@
+#include "cframed_socket.h"
+#include "osac.h"
+#include <chrono>
+
+namespace ipc::core {
+
+static inline int frame_is_interrupted(int error) {
+#if defined(WIN32) || defined(_WIN32)
+    return (error == WSAEINTR);
+#else
+    return (error == EINTR);
+#endif
+}
+
+static inline int frame_would_block(int error) {
+#if defined(WIN32) || defined(_WIN32)
+    return (error == WSAEWOULDBLOCK);
+#else
+    return (error == EAGAIN || error == EWOULDBLOCK);
+#endif
+}
+
+static inline int frame_timed_out() {
+#if defined(WIN32) || defined(_WIN32)
+    return WSAETIMEDOUT;
+#else
+    return ETIMEDOUT;
+#endif
+}
+
+cframed_socket::cframed_socket(csocket &socket, size_t readahead, size_t maxframe) :
+    m_oSocket(socket),
+    m_uMaxFrameSize(maxframe),
+    m_u32SendTimeout(CFRAME_DEFAULT_SEND_TIMEOUT),
+    m_s32PeerClosed(0),
+    m_oStash(readahead > sizeof(FrameHeader_t) ? readahead : CFRAME_DEFAULT_READAHEAD),
+    m_uHead(0),
+    m_uTail(0),
+    m_oFrame(),
+    m_uFrameSize(0),
+    m_uFrameHave(0) {
+}
+
+cframed_socket::~cframed_socket() {
+}
+
+/**
+ * @fn send
+ * @brief send one frame, header and payload are written with one writev call
+ *
+ * @param buff 			Pointer to payload
+ * @param size 			Payload size
+ * @param error 		If not null, set to the socket error when it fails
+ * @return int 			0 if success, otherwise -1
+ */
+int cframed_socket::send(const char *buff, size_t size, int32_t *error) {
+    SOCKET_IOV stPart = {const_cast<char *>(buff), size};
+    return sendv(&stPart, (size > 0 ? 1 : 0), error);
+}
+
+/**
+ * @fn sendv
+ * @brief send one frame whose payload is the concatenation of the given parts
+ *
+ * On a non-blocking socket a full send buffer is waited out for up to the send
+ * timeout, a frame that times out part way leaves the stream unusable.
+ *
+ * @param parts 		Array of payload parts
+ * @param count 		Number of parts (up to CFRAME_MAX_PARTS)
+ * @param error 		If not null, set to the socket error when it fails
+ * @return int 			0 if success, otherwise -1
+ */
+int cframed_socket::sendv(const SOCKET_IOV *parts, size_t count, int32_t *error) {
+    SOCKET_IOV astIov[CFRAME_MAX_PARTS + 1];
+    FrameHeader_t stHeader;
+    size_t uTotal = 0;
+    size_t uIndex = 0;
+    size_t uCount = 0;
+
+    if (count > CFRAME_MAX_PARTS || (count > 0 && parts == NULL)) {
+        OSAC_ERR("[%s] Invalid frame parts\n", __FUNCTION__);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uTotal += parts[i].uSize;
+    }
+    if (uTotal > m_uMaxFrameSize) {
+        OSAC_ERR("[%s] Frame size %zu exceeds limit\n", __FUNCTION__, uTotal);
+        return -1;
+    }
+
+    stHeader.u32Size = htonl(static_cast<uint32_t>(uTotal));
+    astIov[uCount++] = {&stHeader, sizeof(stHeader)};
+    for (size_t i = 0; i < count; i++) {
+        if (parts[i].uSize > 0) {
+            astIov[uCount++] = parts[i];
+        }
+    }
+
+    /* Keep writing until the whole frame is on the wire */
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    while (uIndex < uCount) {
+        int32_t s32Error = 0;
+        int ret = m_oSocket.sendv(&astIov[uIndex], uCount - uIndex, &s32Error);
+        if (ret < 0) {
+            if (frame_is_interrupted(s32Error)) {
+                continue;
+            }
+            /* A partial frame would corrupt the stream, so wait until the send buffer has room */
+            if (frame_would_block(s32Error)) {
+                auto now = std::chrono::steady_clock::now();
+                if (deadline == std::chrono::steady_clock::time_point::max()) {
+                    deadline = now + std::chrono::milliseconds(m_u32SendTimeout);
+                }
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+                int32_t s32WaitError = 0;
+                int ready = (left > 0 ? m_oSocket.wait(SOCKET_WAIT_WRITE, static_cast<int32_t>(left), &s32WaitError) : 0);
+                if (ready > 0 || (ready < 0 && frame_is_interrupted(s32WaitError))) {
+                    continue;
+                }
+                s32Error = (ready == 0 ? frame_timed_out() : s32WaitError);
+            }
+            if (error) {
+                *error = s32Error;
+            }
+            return -1;
+        }
+
+        size_t uSent = static_cast<size_t>(ret);
+        while (uIndex < uCount && uSent >= astIov[uIndex].uSize) {
+            uSent -= astIov[uIndex].uSize;
+            uIndex++;
+        }
+        if (uIndex < uCount) {
+            astIov[uIndex].pBuffer = static_cast<char *>(astIov[uIndex].pBuffer) + uSent;
+            astIov[uIndex].uSize -= uSent;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @fn receive
+ * @brief receive one whole frame
+ *
+ * Frames that fit into the read-ahead buffer are returned in place, so a single
+ * read can deliver many small frames. Larger frames are assembled in a reusable
+ * buffer with readv, scattering the rest of the payload into the frame buffer and
+ * any following bytes into the read-ahead buffer.
+ *
+ * @param frame 		Set to the frame payload, valid until the next receive call
+ * @param error 		If not null, set to the socket error when it fails
+ * @return int 			Payload size, otherwise -1 (see peer_closed())
+ */
+int cframed_socket::receive(const char *&frame, int32_t *error) {
+    while (m_uFrameSize == 0) {
+        size_t uAvail = m_uTail - m_uHead;
+
+        if (uAvail < sizeof(FrameHeader_t)) {
+            compact_stash();
+            if (fill_stash(error) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        FrameHeader_t stHeader;
+        memcpy(&stHeader, &m_oStash[m_uHead], sizeof(stHeader));
+        size_t uSize = ntohl(stHeader.u32Size);
+
+        if (uSize > m_uMaxFrameSize) {
+            OSAC_ERR("[%s] Frame size %zu exceeds limit\n", __FUNCTION__, uSize);
+            return -1;
+        }
+
+        if (uAvail >= sizeof(FrameHeader_t) + uSize) {
+            frame = &m_oStash[m_uHead + sizeof(FrameHeader_t)];
+            m_uHead += sizeof(FrameHeader_t) + uSize;
+            return static_cast<int>(uSize);
+        }
+
+        if (sizeof(FrameHeader_t) + uSize <= m_oStash.size()) {
+            compact_stash();
+            if (fill_stash(error) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        /* Large frame, move the partial payload out and scatter-read the rest */
+        m_uFrameSize = uSize;
+        m_uFrameHave = uAvail - sizeof(FrameHeader_t);
+        m_oFrame.resize(uSize);
+        memcpy(m_oFrame.data(), &m_oStash[m_uHead + sizeof(FrameHeader_t)], m_uFrameHave);
+        m_uHead = 0;
+        m_uTail = 0;
+    }
+
+    while (m_uFrameHave < m_uFrameSize) {
+        SOCKET_IOV astIov[2] = {
+            {m_oFrame.data() + m_uFrameHave, m_uFrameSize - m_uFrameHave},
+            {m_oStash.data(), m_oStash.size()},
+        };
+        int32_t s32Error = 0;
+        int ret = m_oSocket.receivev(astIov, 2, &s32Error);
+        if (ret == 0) {
+            m_s32PeerClosed = 1;
+            return -1;
+        }
+        if (ret < 0) {
+            if (frame_is_interrupted(s32Error)) {
+                continue;
+            }
+            if (error) {
+                *error = s32Error;
+            }
+            /* Progress is kept, a non-blocking caller can call receive again later */
+            return -1;
+        }
+
+        size_t uBytes = static_cast<size_t>(ret);
+        if (uBytes <= m_uFrameSize - m_uFrameHave) {
+            m_uFrameHave += uBytes;
+        } else {
+            m_uTail = uBytes - (m_uFrameSize - m_uFrameHave);
+            m_uFrameHave = m_uFrameSize;
+        }
+    }
+
+    size_t uSize = m_uFrameSize;
+    m_uFrameSize = 0;
+    m_uFrameHave = 0;
+    frame = m_oFrame.data();
+    return static_cast<int>(uSize);
+}
+
+/**
+ * @fn reset
+ * @brief drop any buffered data, used after reconnecting the underlying socket
+ */
+void cframed_socket::reset() {
+    m_uHead = 0;
+    m_uTail = 0;
+    m_uFrameSize = 0;
+    m_uFrameHave = 0;
+    m_s32PeerClosed = 0;
+}
+
+int cframed_socket::fill_stash(int32_t *error) {
+    while (true) {
+        SOCKET_IOV stIov = {&m_oStash[m_uTail], m_oStash.size() - m_uTail};
+        int32_t s32Error = 0;
+        int ret = m_oSocket.receivev(&stIov, 1, &s32Error);
+        if (ret > 0) {
+            m_uTail += static_cast<size_t>(ret);
+            return ret;
+        }
+        if (ret == 0) {
+            m_s32PeerClosed = 1;
+            return -1;
+        }
+        if (!frame_is_interrupted(s32Error)) {
+            if (error) {
+                *error = s32Error;
+            }
+            return -1;
+        }
+    }
+}
+
+void cframed_socket::compact_stash() {
+    if (m_uHead == 0) {
+        return;
+    }
+    if (m_uTail > m_uHead) {
+        memmove(m_oStash.data(), &m_oStash[m_uHead], m_uTail - m_uHead);
+    }
+    m_uTail -= m_uHead;
+    m_uHead = 0;
+}
+} // namespace ipc::core
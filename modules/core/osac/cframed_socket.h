@@ -0,0 +1,121 @@
+/**
+ * @file cframed_socket.h
+ * @author greatboxsS (greatboxS@gmail.com)
+ * @brief Length-prefixed message framing on top of a connected csocket
+ * @version 0.1
+ * @date 2022-08-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef CFRAMED_SOCKET_H
+#define CFRAMED_SOCKET_H
+
+#include "osal/osal.h"
+#include "osac/csocket.h"
+#include <vector>
+
+namespace ipc::core {
+/* Maximum number of payload parts that can be gathered into one frame */
+#define CFRAME_MAX_PARTS         15
+#define CFRAME_DEFAULT_READAHEAD (64U * 1024U)
+#define CFRAME_DEFAULT_MAX_SIZE  (16U * 1024U * 1024U)
+/* Time a frame may wait for room in the send buffer of a non-blocking socket */
+#define CFRAME_DEFAULT_SEND_TIMEOUT 5000U
+
+class __dll_declspec__ cframed_socket {
+private:
+    /* Frame header, payload size in network byte order */
+    typedef struct __FrameHeader_t {
+        uint32_t u32Size;
+    } FrameHeader_t;
+
+    csocket &m_oSocket;
+    size_t m_uMaxFrameSize;
+    uint32_t m_u32SendTimeout;
+    int32_t m_s32PeerClosed;
+    /* Read-ahead buffer, small frames are returned directly from here */
+    std::vector<char> m_oStash;
+    size_t m_uHead;
+    size_t m_uTail;
+    /* Reusable buffer for frames larger than the read-ahead buffer */
+    std::vector<char> m_oFrame;
+    size_t m_uFrameSize;
+    size_t m_uFrameHave;
+
+    int fill_stash(int32_t *error);
+    void compact_stash();
+
+public:
+    /**
+     * @brief Construct a framed socket, the csocket must outlive this object
+     *
+     * @param socket 		Connected stream socket
+     * @param readahead 	Size of the read-ahead buffer
+     * @param maxframe 		Maximum accepted frame payload size
+     */
+    explicit cframed_socket(csocket &socket, size_t readahead = CFRAME_DEFAULT_READAHEAD, size_t maxframe = CFRAME_DEFAULT_MAX_SIZE);
+    ~cframed_socket();
+
+    /**
+     * @fn send
+     * @brief send one frame, header and payload are written with one writev call
+     *
+     * @param buff 			Pointer to payload
+     * @param size 			Payload size
+     * @param error 		If not null, set to the socket error when it fails
+     * @return int 			0 if success, otherwise -1
+     */
+    int send(const char *buff, size_t size, int32_t *error = nullptr);
+
+    /**
+     * @fn sendv
+     * @brief send one frame whose payload is the concatenation of the given parts
+     *
+     * On a non-blocking socket a full send buffer is waited out for up to the send
+     * timeout, a frame that times out part way leaves the stream unusable.
+     *
+     * @param parts 		Array of payload parts
+     * @param count 		Number of parts (up to CFRAME_MAX_PARTS)
+     * @param error 		If not null, set to the socket error when it fails
+     * @return int 			0 if success, otherwise -1
+     */
+    int sendv(const SOCKET_IOV *parts, size_t count, int32_t *error = nullptr);
+
+    /**
+     * @fn receive
+     * @brief receive one whole frame
+     *
+     * On a non-blocking socket -1 is also returned when no whole frame is available
+     * yet, partially received data is kept for the next call.
+     *
+     * @param frame 		Set to the frame payload, valid until the next receive call
+     * @param error 		If not null, set to the socket error when it fails, e.g. would block
+     * @return int 			Payload size, otherwise -1 (see peer_closed())
+     */
+    int receive(const char *&frame, int32_t *error = nullptr);
+
+    /**
+     * @fn set_send_timeout
+     * @brief Set how long a frame may wait for room in the send buffer
+     *
+     * @param ms 			Timeout, the frame fails with a timeout error after it
+     */
+    void set_send_timeout(uint32_t ms) { m_u32SendTimeout = ms; }
+
+    /**
+     * @fn peer_closed
+     * @brief
+     *
+     * @return int 			1 if the remote side closed the connection
+     */
+    int peer_closed() const { return m_s32PeerClosed; }
+
+    /**
+     * @fn reset
+     * @brief drop any buffered data, used after reconnecting the underlying socket
+     */
+    void reset();
+};
+} // namespace ipc::core
+#endif // CFRAMED_SOCKET_H
@@ -1,44 +1,59 @@
 #include "csocket.h"
 #include "osac.h"
-#include "osal/ipc_mutex.h"
 #include "osal/ipc_socket.h"
+#include <thread>
 
 namespace ipc::core {
+/* Counts a data path call, usable() tells whether the socket may still be used by it */
+class csocket_io_scope {
+public:
+    csocket_io_scope(std::atomic<int32_t> &calls, const std::atomic<int32_t> &state) :
+        m_calls(calls),
+        m_state(state) {
+        m_calls.fetch_add(1);
+    }
+    ~csocket_io_scope() { m_calls.fetch_sub(1); }
+
+    /* Read after counting the call, so close() either sees the call or the call sees the close */
+    bool usable() const { return m_state.load() != 0; }
+
+private:
+    std::atomic<int32_t> &m_calls;
+    const std::atomic<int32_t> &m_state;
+};
+
 csocket::csocket(int32_t sockettype, int32_t mode) :
     m_sockettype(sockettype),
     m_mode(mode),
-    m_stSk(),
+    m_s32IsAcceptedSocket(0),
     m_s32IsOpen(0),
     m_s32IsConnected(0),
-    m_s32IsAcceptedSocket(0),
-    m_stRemoteAddr(),
-    m_poSocketSync(NULL) {
-    m_poSocketSync = new cmutex();
-    m_poSocketSync->create();
+    m_s32SendCalls(0),
+    m_s32RecvCalls(0),
+    m_stSk(),
+    m_stRemoteAddr() {
 }
 
 csocket::csocket(SOCKET_T &socket) :
     m_sockettype(-1),
     m_mode(-1),
-    m_stSk(),
+    m_s32IsAcceptedSocket(0),
     m_s32IsOpen(0),
     m_s32IsConnected(0),
-    m_s32IsAcceptedSocket(0),
-    m_stRemoteAddr(),
-    m_poSocketSync(NULL) {
+    m_s32SendCalls(0),
+    m_s32RecvCalls(0),
+    m_stSk(),
+    m_stRemoteAddr() {
     m_stSk = socket;
-    m_poSocketSync = new cmutex();
-    m_poSocketSync->create();
     m_s32IsAcceptedSocket = 1;
-    m_s32IsConnected = 1;
-    m_s32IsOpen = m_stSk.skHandle >= 0 ? 1 : 0;
+    m_s32IsConnected.store(1);
+    m_s32IsOpen.store(m_stSk.skHandle >= 0 ? 1 : 0);
 }
 
 csocket::~csocket() {
     if (is_open()) {
         close();
     }
-    delete m_poSocketSync;
 }
 
 /**
@@ -59,21 +74,29 @@ int csocket::open() {
         return 0;
     }
     m_stSk = socket_create(m_sockettype);
-    m_s32IsOpen = m_stSk.skHandle >= 0 ? 1 : 0;
-    return m_s32IsOpen ? 0 : -1;
+    m_s32IsOpen.store(m_stSk.skHandle >= 0 ? 1 : 0);
+    return m_s32IsOpen.load() ? 0 : -1;
 }
 
 /**
  * @fn close
  * @brief close this socket
  *
+ * The socket is shut down first, so send/receive calls blocked on other threads
+ * return, and the handle is released once none of them is still running.
+ *
  * @return int 			0 if success, otherwise -1
  */
 int csocket::close() {
-    if (is_open()) {
-        m_poSocketSync->lock();
-        m_s32IsOpen = 0;
-        m_poSocketSync->unlock();
+    /* Only the caller that flips the open flag closes the handle, so it is never closed twice */
+    if (m_s32IsOpen.exchange(0) == 0) {
+        return -1;
+    }
+    m_s32IsConnected.store(0);
+    /* Wake calls blocked on the handle, then wait until none can still use it */
+    socket_disconnect(m_stSk);
+    while (m_s32SendCalls.load() > 0 || m_s32RecvCalls.load() > 0) {
+        std::this_thread::yield();
     }
     int ret = socket_close(m_stSk);
     return ret;
@@ -86,7 +109,7 @@ int csocket::close() {
  * @return int
  */
 int csocket::is_open() {
-    return m_s32IsOpen;
+    return m_s32IsOpen.load(std::memory_order_relaxed);
 }
 
 /**
@@ -96,7 +119,7 @@ int csocket::is_open() {
  * @return int
  */
 int csocket::is_connected() {
-    return m_s32IsConnected;
+    return m_s32IsConnected.load(std::memory_order_relaxed);
 }
 
 /**
@@ -108,10 +131,8 @@ int csocket::is_connected() {
  * @return int 			0 if success, otherwise -1
  */
 int csocket::connect(const char *remoteip, uint16_t remoteport) {
-    m_poSocketSync->lock();
     int ret = socket_connect(m_stSk, remoteip, remoteport);
-    m_s32IsConnected = (ret == 0 ? 1 : 0);
-    m_poSocketSync->unlock();
+    m_s32IsConnected.store(ret == 0 ? 1 : 0);
     return ret;
 }
 
@@ -122,10 +143,8 @@ int csocket::connect(const char *remoteip, uint16_t remoteport) {
  * @return int 			0 if success, otherwise -1
  */
 int csocket::disconnect() {
-    m_poSocketSync->lock();
-    m_s32IsConnected = 0;
+    m_s32IsConnected.store(0);
     int ret = socket_disconnect(m_stSk);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -159,16 +178,22 @@ int csocket::listen(uint32_t connection) { return socket_listen(m_stSk, connecti
  * @fn accept
  * @brief Get connected socket of this TCP server socket
  *
+ * @param error 		If not null, set to the error of this call when it fails
  * @return csocket* New remote socket, user must destroys it.
  */
-csocket *csocket::accept() {
+csocket *csocket::accept(int32_t *error) {
     csocket *poAcceptSk = NULL;
-    m_poSocketSync->lock();
+    csocket_io_scope scope(m_s32RecvCalls, m_s32IsOpen);
+    if (!scope.usable()) {
+        return poAcceptSk;
+    }
     auto sk = socket_accept(m_stSk);
     if (sk.skHandle > 0) {
         poAcceptSk = new csocket(sk);
+    } else if (error) {
+        /* e.g. EAGAIN when no connection is pending on a non-blocking socket */
+        *error = sk.s32Error;
     }
-    m_poSocketSync->unlock();
     return poAcceptSk;
 }
 
@@ -178,16 +203,16 @@ csocket *csocket::accept() {
  *
  * @param buff 			Pointer to buffer
  * @param size 			Buffer size
+ * @param error 		If not null, set to the error of this call when it fails
  * @return int 			0 if success, otherwise -1
  */
-int csocket::send(const char *buff, size_t size) {
+int csocket::send(const char *buff, size_t size, int32_t *error) {
     int ret = -1;
-    if (!is_connected()) {
+    csocket_io_scope scope(m_s32SendCalls, m_s32IsConnected);
+    if (!scope.usable()) {
         return ret;
     }
-    m_poSocketSync->lock();
-    ret = socket_send(m_stSk, buff, size);
-    m_poSocketSync->unlock();
+    ret = socket_send(m_stSk, buff, size, error);
     return ret;
 }
 
@@ -197,16 +222,75 @@ int csocket::send(const char *buff, size_t size) {
  *
  * @param buff 			Pointer to buffer
  * @param size 			Buffer size
+ * @param error 		If not null, set to the error of this call when it fails
  * @return int 			0 if success, otherwise -1
  */
-int csocket::receive(char *buff, size_t size) {
+int csocket::receive(char *buff, size_t size, int32_t *error) {
+    int ret = -1;
+    csocket_io_scope scope(m_s32RecvCalls, m_s32IsConnected);
+    if (!scope.usable()) {
+        return ret;
+    }
+    ret = socket_recv(m_stSk, buff, size, error);
+    return ret;
+}
+
+/**
+ * @fn sendv
+ * @brief gather send, buffers are written in order with one system call
+ *
+ * @param iov 			Array of buffers
+ * @param count 		Number of buffers
+ * @param error 		If not null, set to the error of this call when it fails
+ * @return int 			Number of bytes sent, otherwise -1
+ */
+int csocket::sendv(const SOCKET_IOV *iov, size_t count, int32_t *error) {
+    int ret = -1;
+    csocket_io_scope scope(m_s32SendCalls, m_s32IsConnected);
+    if (!scope.usable()) {
+        return ret;
+    }
+    ret = socket_sendv(m_stSk, iov, count, error);
+    return ret;
+}
+
+/**
+ * @fn receivev
+ * @brief scatter receive, received data fills buffers in order with one system call
+ *
+ * @param iov 			Array of buffers
+ * @param count 		Number of buffers
+ * @param error 		If not null, set to the error of this call when it fails
+ * @return int 			Number of bytes received, 0 if peer closed, otherwise -1
+ */
+int csocket::receivev(const SOCKET_IOV *iov, size_t count, int32_t *error) {
     int ret = -1;
-    if (!is_connected()) {
+    csocket_io_scope scope(m_s32RecvCalls, m_s32IsConnected);
+    if (!scope.usable()) {
         return ret;
     }
-    m_poSocketSync->lock();
-    ret = socket_recv(m_stSk, buff, size);
-    m_poSocketSync->unlock();
+    ret = socket_recvv(m_stSk, iov, count, error);
+    return ret;
+}
+
+/**
+ * @fn wait
+ * @brief Wait until the socket is readable and/or writable, e.g. on a non-blocking socket
+ *
+ * @param events 		SOCKET_WAIT_READ and/or SOCKET_WAIT_WRITE
+ * @param ms 			Timeout, -1 waits without limit
+ * @param error 		If not null, set to the error of this call when it fails
+ * @return int 			1 if ready, 0 on timeout, otherwise -1
+ */
+int csocket::wait(int32_t events, int32_t ms, int32_t *error) {
+    int ret = -1;
+    /* A write wait belongs to the sending side, so it does not share the receiver's counter */
+    std::atomic<int32_t> &calls = ((events & SOCKET_WAIT_WRITE) ? m_s32SendCalls : m_s32RecvCalls);
+    csocket_io_scope scope(calls, m_s32IsOpen);
+    if (!scope.usable()) {
+        return ret;
+    }
+    ret = socket_wait(m_stSk, events, ms, error);
     return ret;
 }
 
@@ -218,14 +302,17 @@ int csocket::receive(char *buff, size_t size) {
  * @param port 			Remote port
  * @param buff 			Pointer to buffer
  * @param size 			Buffer size
+ * @param error 		If not null, set to the error of this call when it fails
  * @return int 			0 if success, otherwise -1
  */
-int csocket::send_to(const char *ip, uint16_t port, const char *buff, size_t size) {
-    int ret = 0;
+int csocket::send_to(const char *ip, uint16_t port, const char *buff, size_t size, int32_t *error) {
+    int ret = -1;
+    csocket_io_scope scope(m_s32SendCalls, m_s32IsOpen);
+    if (!scope.usable()) {
+        return ret;
+    }
     SOCKADDR_T stAddr = socket_get_addr_v4(ip, port);
-    m_poSocketSync->lock();
-    ret = socket_send_to(m_stSk, stAddr, buff, size);
-    m_poSocketSync->unlock();
+    ret = socket_send_to(m_stSk, stAddr, buff, size, error);
     return ret;
 }
 
@@ -236,13 +323,16 @@ int csocket::send_to(const char *ip, uint16_t port, const char *buff, size_t siz
  * @param buff 			Pointer to buffer
  * @param size 			Buffer size
  * @param addr 			Target host address that this socket is received from
+ * @param error 		If not null, set to the error of this call when it fails
  * @return int 			0 if success, otherwise -1
  */
-int csocket::receive_from(char *buff, size_t size, SOCKADDR_T &addr) {
-    int ret = 0;
-    m_poSocketSync->lock();
-    ret = socket_recv_from(m_stSk, addr, buff, size);
-    m_poSocketSync->unlock();
+int csocket::receive_from(char *buff, size_t size, SOCKADDR_T &addr, int32_t *error) {
+    int ret = -1;
+    csocket_io_scope scope(m_s32RecvCalls, m_s32IsOpen);
+    if (!scope.usable()) {
+        return ret;
+    }
+    ret = socket_recv_from(m_stSk, addr, buff, size, error);
     return ret;
 }
 
@@ -254,16 +344,94 @@ int csocket::receive_from(char *buff, size_t size, SOCKADDR_T &addr) {
  * @param port 			Groupt port
  * @param buff 			Pointer to buffer
  * @param size 			Buffer size
+ * @param error 		If not null, set to the error of this call when it fails
  * @return int 			0 if success, otherwise -1
  */
-int csocket::send_multicast(const char *groupip, uint16_t port, const char *buff, size_t size) {
-    int ret = 0;
-    m_poSocketSync->lock();
-    ret = socket_send_multicast(m_stSk, groupip, port, buff, size);
-    m_poSocketSync->unlock();
+int csocket::send_multicast(const char *groupip, uint16_t port, const char *buff, size_t size, int32_t *error) {
+    int ret = -1;
+    csocket_io_scope scope(m_s32SendCalls, m_s32IsOpen);
+    if (!scope.usable()) {
+        return ret;
+    }
+    ret = socket_send_multicast(m_stSk, groupip, port, buff, size, error);
     return ret;
 }
 
+/**
+ * @fn join_multicast
+ * @brief Join a multicast group, any source
+ *
+ * @param groupip 		Multicast group Ip
+ * @param ifaceip 		Local interface Ip, nullptr lets the system choose
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::join_multicast(const char *groupip, const char *ifaceip) {
+    return socket_join_multicast(m_stSk, groupip, ifaceip);
+}
+
+/**
+ * @fn leave_multicast
+ * @brief Leave a multicast group joined with join_multicast
+ *
+ * @param groupip 		Multicast group Ip
+ * @param ifaceip 		Local interface Ip
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::leave_multicast(const char *groupip, const char *ifaceip) {
+    return socket_leave_multicast(m_stSk, groupip, ifaceip);
+}
+
+/**
+ * @fn join_source_multicast
+ * @brief Join a multicast group, only datagrams sent by sourceip are received
+ *
+ * @param groupip 		Multicast group Ip
+ * @param sourceip 		Source Ip
+ * @param ifaceip 		Local interface Ip, nullptr lets the system choose
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::join_source_multicast(const char *groupip, const char *sourceip, const char *ifaceip) {
+    return socket_join_source_multicast(m_stSk, groupip, sourceip, ifaceip);
+}
+
+/**
+ * @fn leave_source_multicast
+ * @brief Leave a source-specific membership joined with join_source_multicast
+ *
+ * @param groupip 		Multicast group Ip
+ * @param sourceip 		Source Ip
+ * @param ifaceip 		Local interface Ip
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::leave_source_multicast(const char *groupip, const char *sourceip, const char *ifaceip) {
+    return socket_leave_source_multicast(m_stSk, groupip, sourceip, ifaceip);
+}
+
+/**
+ * @fn set_multicast_all
+ * @brief Receive groups joined by other sockets on the same port too (Linux default)
+ *
+ * @param enable 		1 to enable, 0 to receive only the groups joined on this socket
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::set_multicast_all(int enable) {
+    return socket_set_multicast_all(m_stSk, enable);
+}
+
+/**
+ * @fn set_shard_filter
+ * @brief Only queue datagrams whose big endian 32-bit key at the payload offset
+ *        satisfies key % count == index
+ *
+ * @param offset 		Key offset in the datagram payload
+ * @param count 		Number of shards
+ * @param index 		Shard of this socket
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::set_shard_filter(uint32_t offset, uint32_t count, uint32_t index) {
+    return socket_set_udp_shard_filter(m_stSk, offset, count, index);
+}
+
 /**
  * @fn set_recv_buff_size
  * @brief Set the socket receive buffer size
@@ -273,9 +441,7 @@ int csocket::send_multicast(const char *groupip, uint16_t port, const char *buff
  */
 int csocket::set_recv_buff_size(uint32_t size) {
     int ret = 0;
-    m_poSocketSync->lock();
     ret = socket_set_recv_buff(m_stSk, size);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -288,9 +454,7 @@ int csocket::set_recv_buff_size(uint32_t size) {
  */
 int csocket::set_send_buff_size(uint32_t size) {
     int ret = 0;
-    m_poSocketSync->lock();
     ret = socket_set_send_buff(m_stSk, size);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -303,9 +467,7 @@ int csocket::set_send_buff_size(uint32_t size) {
  */
 int csocket::set_blocking_mode(int mode) {
     int ret = 0;
-    m_poSocketSync->lock();
     ret = socket_set_blocking_mode(m_stSk, mode);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -318,9 +480,7 @@ int csocket::set_blocking_mode(int mode) {
  */
 int csocket::set_recv_timeout(uint32_t ms) {
     int ret = 0;
-    m_poSocketSync->lock();
     ret = socket_set_recv_timeout(m_stSk, ms);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -333,9 +493,7 @@ int csocket::set_recv_timeout(uint32_t ms) {
  */
 int csocket::set_send_timeout(uint32_t ms) {
     int ret = 0;
-    m_poSocketSync->lock();
     ret = socket_set_send_timeout(m_stSk, ms);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -352,9 +510,7 @@ int csocket::set_send_timeout(uint32_t ms) {
 int csocket::set_option(int32_t opt, int32_t level, void *optvalue, size_t optsize) {
     int ret = 0;
     SOCKET_OPT stOpt = {level, opt, optvalue, optsize};
-    m_poSocketSync->lock();
     ret = socket_set_option(m_stSk, stOpt);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -371,9 +527,7 @@ int csocket::set_option(int32_t opt, int32_t level, void *optvalue, size_t optsi
 int csocket::get_option(int32_t opt, int32_t level, void *optbuff, size_t optsize) {
     int ret = 0;
     SOCKET_OPT stOpt = {level, opt, optbuff, optsize};
-    m_poSocketSync->lock();
     ret = socket_get_option(m_stSk, stOpt);
-    m_poSocketSync->unlock();
     return ret;
 }
 
@@ -401,6 +555,90 @@ SOCKADDR_T csocket::get_socket_addr() {
     return socket_get_name(m_stSk);
 }
 
+/**
+ * @fn set_reuse_port
+ * @brief Let several sockets bind the same port (SO_REUSEPORT), must be set before bind
+ *
+ * @param enable 		1 to enable, 0 to disable
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::set_reuse_port(int enable) {
+    return socket_set_reuse_port(m_stSk, enable);
+}
+
+/**
+ * @fn set_reuse_port_cpu_steering
+ * @brief Deliver connections of the SO_REUSEPORT group to the socket whose index
+ *        matches the receiving CPU, see socket_set_reuse_port_cpu_steering
+ *
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::set_reuse_port_cpu_steering() {
+    return socket_set_reuse_port_cpu_steering(m_stSk);
+}
+
+/**
+ * @fn apply_profile
+ * @brief Configure the options of a use case together, nothing is changed if a
+ *        required option cannot be set
+ *
+ * @param profile 		Predefined profile
+ * @param applied 		If not null, the option values the kernel actually uses
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::apply_profile(Profile profile, SOCKET_PROFILE *applied) {
+    return apply_profile(socket_get_profile_preset(static_cast<int32_t>(profile)), applied);
+}
+
+/**
+ * @fn apply_profile
+ * @brief Same as above with custom values, -1 leaves an option untouched
+ *
+ * @param profile 		Option values
+ * @param applied 		If not null, the option values the kernel actually uses
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::apply_profile(const SOCKET_PROFILE &profile, SOCKET_PROFILE *applied) {
+    SOCKET_PROFILE stApplied;
+    int ret = socket_apply_profile(m_stSk, profile, stApplied);
+    if (applied != nullptr) {
+        *applied = stApplied;
+    }
+    return ret;
+}
+
+/**
+ * @fn get_profile
+ * @brief Read the current values of the profile options
+ *
+ * @param current 		-1 for options that do not apply to this socket
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::get_profile(SOCKET_PROFILE &current) {
+    return socket_get_profile(m_stSk, current);
+}
+
+/**
+ * @fn flush
+ * @brief Send data held back by the Bulk profile (TCP_CORK) now
+ *
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::flush() {
+    return socket_flush_cork(m_stSk);
+}
+
+/**
+ * @fn get_peer_cred
+ * @brief Get the credentials of the peer process, local connected sockets only
+ *
+ * @param cred 			Peer pid/uid/gid
+ * @return int 			0 if success, otherwise -1
+ */
+int csocket::get_peer_cred(SOCKET_CRED &cred) {
+    return socket_get_peer_cred(m_stSk, cred);
+}
+
 /**
  * @fn ipv4_to_string
  * @brief
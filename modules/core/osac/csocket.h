@@ -12,7 +12,7 @@
 #define CSOCKET_H
 
 #include "osal/osal.h"
-#include "osac/cmutex.h"
+#include <atomic>
 
 namespace ipc::core {
 #define SOCKET_IP_ADDR_ANY           "0.0.0.0"
@@ -21,9 +21,10 @@ namespace ipc::core {
 class __dll_declspec__ csocket {
 public:
     enum class Type : int32_t {
-        SocketHost = 0,
+        SocketHost = 0, /* Local socket, message boundaries preserved */
         SocketTcp,
         SocketUdp,
+        SocketHostStream, /* Local socket, byte stream */
     };
 
     enum class Mode : int32_t {
@@ -31,15 +32,25 @@ public:
         Server,
     };
 
+    enum class Profile : int32_t {
+        Default = eSOCKET_PROFILE_DEFAULT,
+        LowLatency = eSOCKET_PROFILE_LOW_LATENCY, /* Request/response, small messages */
+        Bulk = eSOCKET_PROFILE_BULK,              /* Streaming, throughput over latency, see flush() */
+    };
+
 protected:
     int32_t m_sockettype;
     int32_t m_mode;
     int32_t m_s32IsAcceptedSocket;
-    int32_t m_s32IsOpen;
-    int32_t m_s32IsConnected;
+    /* No lock around I/O, send and receive may run on different threads at the same time */
+    std::atomic<int32_t> m_s32IsOpen;
+    std::atomic<int32_t> m_s32IsConnected;
+    /* Data path calls in progress, close() waits for them so none can use a reused handle */
+    /* One counter per direction on its own cache line, a sender and a receiver never share it */
+    alignas(64) std::atomic<int32_t> m_s32SendCalls;
+    alignas(64) std::atomic<int32_t> m_s32RecvCalls;
     SOCKET_T m_stSk;
     SOCKADDR_T m_stRemoteAddr;
-    cmutex *m_poSocketSync;
 
     explicit csocket(SOCKET_T &socket);
 
@@ -61,6 +72,9 @@ public:
      * @fn close
      * @brief close this socket
      *
+     * The socket is shut down first, so send/receive calls blocked on other threads
+     * return, and the handle is released once none of them is still running.
+     *
      * @return int 			0 if success, otherwise -1
      */
     int close();
@@ -124,9 +138,10 @@ public:
      * @fn accept
      * @brief Get connected socket of this TCP server socket
      *
+     * @param error 		If not null, set to the error of this call when it fails
      * @return csocket* New remote socket, user must destroys it.
      */
-    csocket *accept();
+    csocket *accept(int32_t *error = nullptr);
 
     /**
      * @fn send
@@ -134,9 +149,10 @@ public:
      *
      * @param buff 			Pointer to buffer
      * @param size 			Buffer size
+     * @param error 		If not null, set to the error of this call when it fails
      * @return int 			0 if success, otherwise -1
      */
-    int send(const char *buff, size_t size);
+    int send(const char *buff, size_t size, int32_t *error = nullptr);
 
     /**
      * @fn receive
@@ -144,9 +160,43 @@ public:
      *
      * @param buff 			Pointer to buffer
      * @param size 			Buffer size
+     * @param error 		If not null, set to the error of this call when it fails
      * @return int 			0 if success, otherwise -1
      */
-    int receive(char *buff, size_t size);
+    int receive(char *buff, size_t size, int32_t *error = nullptr);
+
+    /**
+     * @fn sendv
+     * @brief gather send, buffers are written in order with one system call
+     *
+     * @param iov 			Array of buffers
+     * @param count 		Number of buffers
+     * @param error 		If not null, set to the error of this call when it fails
+     * @return int 			Number of bytes sent, otherwise -1
+     */
+    int sendv(const SOCKET_IOV *iov, size_t count, int32_t *error = nullptr);
+
+    /**
+     * @fn receivev
+     * @brief scatter receive, received data fills buffers in order with one system call
+     *
+     * @param iov 			Array of buffers
+     * @param count 		Number of buffers
+     * @param error 		If not null, set to the error of this call when it fails
+     * @return int 			Number of bytes received, 0 if peer closed, otherwise -1
+     */
+    int receivev(const SOCKET_IOV *iov, size_t count, int32_t *error = nullptr);
+
+    /**
+     * @fn wait
+     * @brief Wait until the socket is readable and/or writable, e.g. on a non-blocking socket
+     *
+     * @param events 		SOCKET_WAIT_READ and/or SOCKET_WAIT_WRITE
+     * @param ms 			Timeout, -1 waits without limit
+     * @param error 		If not null, set to the error of this call when it fails
+     * @return int 			1 if ready, 0 on timeout, otherwise -1
+     */
+    int wait(int32_t events, int32_t ms, int32_t *error = nullptr);
 
     /**
      * @fn send_to
@@ -156,9 +206,10 @@ public:
      * @param port 			Remote port
      * @param buff 			Pointer to buffer
      * @param size 			Buffer size
+     * @param error 		If not null, set to the error of this call when it fails
      * @return int 			0 if success, otherwise -1
      */
-    int send_to(const char *ip, uint16_t port, const char *buff, size_t size);
+    int send_to(const char *ip, uint16_t port, const char *buff, size_t size, int32_t *error = nullptr);
 
     /**
      * @fn receive_from
@@ -167,9 +218,10 @@ public:
      * @param buff 			Pointer to buffer
      * @param size 			Buffer size
      * @param addr 			Target host address that this socket is received from
+     * @param error 		If not null, set to the error of this call when it fails
      * @return int 			0 if success, otherwise -1
      */
-    int receive_from(char *buff, size_t size, SOCKADDR_T &addr);
+    int receive_from(char *buff, size_t size, SOCKADDR_T &addr, int32_t *error = nullptr);
 
     /**
      * @fn send_multicast
@@ -179,9 +231,73 @@ public:
      * @param port 			Groupt port
      * @param buff 			Pointer to buffer
      * @param size 			Buffer size
+     * @param error 		If not null, set to the error of this call when it fails
+     * @return int 			0 if success, otherwise -1
+     */
+    int send_multicast(const char *groupip, uint16_t port, const char *buff, size_t size, int32_t *error = nullptr);
+
+    /**
+     * @fn join_multicast
+     * @brief Join a multicast group, any source
+     *
+     * @param groupip 		Multicast group Ip
+     * @param ifaceip 		Local interface Ip, nullptr lets the system choose
+     * @return int 			0 if success, otherwise -1
+     */
+    int join_multicast(const char *groupip, const char *ifaceip = nullptr);
+
+    /**
+     * @fn leave_multicast
+     * @brief Leave a multicast group joined with join_multicast
+     *
+     * @param groupip 		Multicast group Ip
+     * @param ifaceip 		Local interface Ip
+     * @return int 			0 if success, otherwise -1
+     */
+    int leave_multicast(const char *groupip, const char *ifaceip = nullptr);
+
+    /**
+     * @fn join_source_multicast
+     * @brief Join a multicast group, only datagrams sent by sourceip are received
+     *
+     * @param groupip 		Multicast group Ip
+     * @param sourceip 		Source Ip
+     * @param ifaceip 		Local interface Ip, nullptr lets the system choose
+     * @return int 			0 if success, otherwise -1
+     */
+    int join_source_multicast(const char *groupip, const char *sourceip, const char *ifaceip = nullptr);
+
+    /**
+     * @fn leave_source_multicast
+     * @brief Leave a source-specific membership joined with join_source_multicast
+     *
+     * @param groupip 		Multicast group Ip
+     * @param sourceip 		Source Ip
+     * @param ifaceip 		Local interface Ip
+     * @return int 			0 if success, otherwise -1
+     */
+    int leave_source_multicast(const char *groupip, const char *sourceip, const char *ifaceip = nullptr);
+
+    /**
+     * @fn set_multicast_all
+     * @brief Receive groups joined by other sockets on the same port too (Linux default)
+     *
+     * @param enable 		1 to enable, 0 to receive only the groups joined on this socket
      * @return int 			0 if success, otherwise -1
      */
-    int send_multicast(const char *groupip, uint16_t port, const char *buff, size_t size);
+    int set_multicast_all(int enable);
+
+    /**
+     * @fn set_shard_filter
+     * @brief Only queue datagrams whose big endian 32-bit key at the payload offset
+     *        satisfies key % count == index
+     *
+     * @param offset 		Key offset in the datagram payload
+     * @param count 		Number of shards
+     * @param index 		Shard of this socket
+     * @return int 			0 if success, otherwise -1
+     */
+    int set_shard_filter(uint32_t offset, uint32_t count, uint32_t index);
 
     /**
      * @fn set_recv_buff_size
@@ -252,6 +368,58 @@ public:
      */
     int get_option(int32_t opt, int32_t level, void *optbuff, size_t optsize);
 
+    /**
+     * @fn set_reuse_port
+     * @brief Let several sockets bind the same port (SO_REUSEPORT), must be set before bind
+     *
+     * @param enable 		1 to enable, 0 to disable
+     * @return int 			0 if success, otherwise -1
+     */
+    int set_reuse_port(int enable);
+
+    /**
+     * @fn set_reuse_port_cpu_steering
+     * @brief Deliver connections of the SO_REUSEPORT group to the socket whose index
+     *        matches the receiving CPU, see socket_set_reuse_port_cpu_steering
+     *
+     * @return int 			0 if success, otherwise -1
+     */
+    int set_reuse_port_cpu_steering();
+
+    /**
+     * @fn apply_profile
+     * @brief Configure the options of a use case together, nothing is changed if a
+     *        required option cannot be set
+     *
+     * @param profile 		Predefined profile
+     * @param applied 		If not null, the option values the kernel actually uses
+     * @return int 			0 if success, otherwise -1
+     */
+    int apply_profile(Profile profile, SOCKET_PROFILE *applied = nullptr);
+
+    /**
+     * @fn apply_profile
+     * @brief Same as above with custom values, -1 leaves an option untouched
+     */
+    int apply_profile(const SOCKET_PROFILE &profile, SOCKET_PROFILE *applied = nullptr);
+
+    /**
+     * @fn get_profile
+     * @brief Read the current values of the profile options
+     *
+     * @param current 		-1 for options that do not apply to this socket
+     * @return int 			0 if success, otherwise -1
+     */
+    int get_profile(SOCKET_PROFILE &current);
+
+    /**
+     * @fn flush
+     * @brief Send data held back by the Bulk profile (TCP_CORK) now
+     *
+     * @return int 			0 if success, otherwise -1
+     */
+    int flush();
+
     /**
      * @fn get_addr_str
      * @brief Get the Address string
@@ -270,12 +438,32 @@ public:
 
     /**
      * @fn get_error
-     * @brief Get the error value
+     * @brief Get the error of the last failed setup call (open, bind, connect, options...)
+     *
+     * Send/receive calls report their error through their error argument instead, as
+     * they may run on several threads at once.
      *
      * @return int
      */
     int get_error() { return m_stSk.s32Error; }
 
+    /**
+     * @fn get_handle
+     * @brief Get the native socket handle, e.g. for registering with poll/epoll
+     *
+     * @return SOCKET 		INVALID_SOCKET once the socket is closed
+     */
+    SOCKET get_handle() const { return (m_s32IsOpen.load() ? m_stSk.skHandle : INVALID_SOCKET); }
+
+    /**
+     * @fn get_peer_cred
+     * @brief Get the credentials of the peer process, local connected sockets only
+     *
+     * @param cred 			Peer pid/uid/gid
+     * @return int 			0 if success, otherwise -1
+     */
+    int get_peer_cred(SOCKET_CRED &cred);
+
     /**
      * @fn ipv4_to_string
      * @brief
@@ -13,13 +13,25 @@ __dll_declspec__ int socket_listen(SOCKET_T &sk, uint32_t connection);
 __dll_declspec__ int socket_bind(SOCKET_T &sk, uint16_t port, const char *path = nullptr);
 __dll_declspec__ SOCKET_T socket_accept(SOCKET_T &sk);
 
-__dll_declspec__ int socket_send(SOCKET_T &sk, const char *buff, size_t size);
-__dll_declspec__ int socket_recv(SOCKET_T &sk, char *buff, size_t size);
+__dll_declspec__ int socket_send(SOCKET_T &sk, const char *buff, size_t size, int32_t *error = nullptr);
+__dll_declspec__ int socket_recv(SOCKET_T &sk, char *buff, size_t size, int32_t *error = nullptr);
 
-__dll_declspec__ int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t size);
-__dll_declspec__ int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size);
+__dll_declspec__ int socket_sendv(SOCKET_T &sk, const SOCKET_IOV *iov, size_t count, int32_t *error = nullptr);
+__dll_declspec__ int socket_recvv(SOCKET_T &sk, const SOCKET_IOV *iov, size_t count, int32_t *error = nullptr);
 
-__dll_declspec__ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, const char *buff, size_t size);
+__dll_declspec__ int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t size, int32_t *error = nullptr);
+__dll_declspec__ int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size, int32_t *error = nullptr);
+
+__dll_declspec__ int socket_wait(SOCKET_T &sk, int32_t events, int32_t timeout_ms, int32_t *error = nullptr);
+
+__dll_declspec__ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, const char *buff, size_t size, int32_t *error = nullptr);
+
+__dll_declspec__ int socket_join_multicast(SOCKET_T &sk, const char *groupip, const char *ifaceip = nullptr);
+__dll_declspec__ int socket_leave_multicast(SOCKET_T &sk, const char *groupip, const char *ifaceip = nullptr);
+__dll_declspec__ int socket_join_source_multicast(SOCKET_T &sk, const char *groupip, const char *sourceip, const char *ifaceip = nullptr);
+__dll_declspec__ int socket_leave_source_multicast(SOCKET_T &sk, const char *groupip, const char *sourceip, const char *ifaceip = nullptr);
+__dll_declspec__ int socket_set_multicast_all(SOCKET_T &sk, int32_t enable);
+__dll_declspec__ int socket_set_udp_shard_filter(SOCKET_T &sk, uint32_t offset, uint32_t count, uint32_t index);
 
 __dll_declspec__ int socket_set_recv_buff(SOCKET_T &sk, uint32_t size);
 __dll_declspec__ int socket_set_send_buff(SOCKET_T &sk, uint32_t size);
@@ -32,6 +44,14 @@ __dll_declspec__ int socket_set_blocking_mode(SOCKET_T &sk, int32_t mode);
 __dll_declspec__ int socket_set_option(SOCKET_T &sk, SOCKET_OPT &opt);
 __dll_declspec__ int socket_get_option(SOCKET_T &sk, SOCKET_OPT &opt);
 
+__dll_declspec__ SOCKET_PROFILE socket_get_profile_preset(int32_t profile);
+__dll_declspec__ int socket_apply_profile(SOCKET_T &sk, const SOCKET_PROFILE &profile, SOCKET_PROFILE &applied);
+__dll_declspec__ int socket_get_profile(SOCKET_T &sk, SOCKET_PROFILE &current);
+__dll_declspec__ int socket_flush_cork(SOCKET_T &sk);
+
+__dll_declspec__ int socket_set_reuse_port(SOCKET_T &sk, int32_t enable);
+__dll_declspec__ int socket_set_reuse_port_cpu_steering(SOCKET_T &sk);
+
 __dll_declspec__ SOCKADDR_T socket_get_addr_v4(const char *ip, uint16_t port);
 __dll_declspec__ SOCKADDR_T socket_get_addr_v6(const char *ip, uint16_t port);
 
@@ -39,5 +59,7 @@ __dll_declspec__ const char *socket_ip_v4_to_string(SOCKADDR_T &addr);
 __dll_declspec__ const char *socket_ip_v6_to_string(SOCKADDR_T &addr);
 
 __dll_declspec__ SOCKADDR_T socket_get_name(SOCKET_T &sk);
+
+__dll_declspec__ int socket_get_peer_cred(SOCKET_T &sk, SOCKET_CRED &cred);
 }
 #endif // IPC_SOCKET_H
\ No newline at end of file
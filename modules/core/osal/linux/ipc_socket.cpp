@@ -1,11 +1,55 @@
 #include "osal/ipc_socket.h"
 #include <arpa/inet.h>
+#include <limits.h>
+#include <linux/filter.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <stddef.h>
+#include <sys/uio.h>
 
 namespace ipc::core {
+static_assert(sizeof(SOCKET_IOV) == sizeof(struct iovec), "SOCKET_IOV must match struct iovec");
+static_assert(offsetof(SOCKET_IOV, pBuffer) == offsetof(struct iovec, iov_base), "SOCKET_IOV must match struct iovec");
+static_assert(offsetof(SOCKET_IOV, uSize) == offsetof(struct iovec, iov_len), "SOCKET_IOV must match struct iovec");
+
 static inline int socket_is_valid(SOCKET_T &sk) {
     return (sk.skHandle == -1 ? 0 : 1);
 }
 
+/* Data path calls run on several threads at once, so they report errors per call, not in sk */
+static inline void socket_set_error(int32_t *error, int32_t value) {
+    if (error) {
+        *error = value;
+    }
+}
+
+/**
+ * @fn socket_get_addr_un
+ * @brief Fill a local socket address, a leading '@' selects the Linux abstract namespace
+ *
+ * @param addr
+ * @param path
+ * @return socklen_t    Address length to pass to bind/connect
+ */
+static socklen_t socket_get_addr_un(SOCKADDR_H &addr, const char *path) {
+    size_t len = strlen(path);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (len > sizeof(addr.sun_path) - 1) {
+        len = sizeof(addr.sun_path) - 1;
+    }
+    memcpy(addr.sun_path, path, len);
+
+    if (path[0] == '@') {
+        /* Abstract addresses are not NUL terminated, the length is part of the name */
+        addr.sun_path[0] = '\0';
+        return static_cast<socklen_t>(offsetof(SOCKADDR_H, sun_path) + len);
+    }
+    return static_cast<socklen_t>(sizeof(SOCKADDR_H));
+}
+
 SOCKET_T socket_create(int32_t sockettype, int blockmode, int addrfamily) {
     SOCKET_T stSocket;
     int domain = AF_UNIX;
@@ -28,11 +72,11 @@ SOCKET_T socket_create(int32_t sockettype, int blockmode, int addrfamily) {
 
     if (sockettype == eSOCKET_TCP) {
         type = SOCK_STREAM;
-    } else if (sockettype = eSOCKET_UDP) {
+    } else if (sockettype == eSOCKET_UDP) {
         type = SOCK_DGRAM;
-    } else if (sockettype = eSOCKET_HOST) {
+    } else if (sockettype == eSOCKET_HOST || sockettype == eSOCKET_HOST_STREAM) {
         domain = AF_UNIX;
-        type = SOCK_SEQPACKET;
+        type = (sockettype == eSOCKET_HOST ? SOCK_SEQPACKET : SOCK_STREAM);
         family = AF_UNIX;
         addr_size = sizeof(SOCKADDR_H);
     } else {
@@ -82,7 +126,7 @@ int socket_connect(SOCKET_T &sk, const char *remoteip, uint16_t remoteport) {
         return RET_ERR;
     }
 
-    if (sk.s32SocketType != eSOCKET_TCP) {
+    if (sk.s32SocketType == eSOCKET_UDP) {
         OSAL_INFO("[%s] Can not connect a not streaming socket\n", __FUNCTION__);
         return RET_ERR;
     }
@@ -110,11 +154,7 @@ int socket_connect(SOCKET_T &sk, const char *remoteip, uint16_t remoteport) {
 
         socketaddr = &v6_addr;
     } else {
-        size = sizeof(SOCKADDR_H);
-        memset(&un_addr, 0, sizeof(SOCKADDR_H));
-        un_addr.sun_family = AF_UNIX;
-        strncpy(un_addr.sun_path, remoteip, sizeof(un_addr.sun_path) - 1);
-
+        size = socket_get_addr_un(un_addr, remoteip);
         socketaddr = &un_addr;
     }
 
@@ -177,10 +217,10 @@ int socket_bind(SOCKET_T &sk, uint16_t port, const char *path) {
         socketaddr = &v6_addr;
     } else {
         if (path != nullptr) {
-            memset(&un_addr, 0, sizeof(un_addr));
-            un_addr.sun_family = AF_UNIX;
-            strncpy(un_addr.sun_path, path, sizeof(un_addr.sun_path) - 1);
-            unlink(path);
+            size = socket_get_addr_un(un_addr, path);
+            if (path[0] != '@') {
+                unlink(path);
+            }
             socketaddr = &un_addr;
         } else {
             OSAL_ERR("Invalid socket path\n");
@@ -221,7 +261,8 @@ SOCKET_T socket_accept(SOCKET_T &sk) {
     memset(&stSocket, 0, sizeof(stSocket));
     stSocket.skHandle = -1;
 
-    /* accept socket ip version will be inherited from host socket */
+    /* accept socket ip version and type will be inherited from host socket */
+    stSocket.s32SocketType = sk.s32SocketType;
     stSocket.stAddrInet.s32AddrFamily = sk.stAddrInet.s32AddrFamily;
     if (stSocket.stAddrInet.s32AddrFamily == SOCKET_ADDR_V4) {
         stSocket.stAddrInet.u32Size = sizeof(SOCKADDR_V4);
@@ -243,7 +284,7 @@ SOCKET_T socket_accept(SOCKET_T &sk) {
     return stSocket;
 }
 
-int socket_send(SOCKET_T &sk, const char *buff, size_t size) {
+int socket_send(SOCKET_T &sk, const char *buff, size_t size, int32_t *error) {
     int bytes = 0;
 
     if (!socket_is_valid(sk)) {
@@ -255,15 +296,16 @@ int socket_send(SOCKET_T &sk, const char *buff, size_t size) {
         return RET_ERR;
     }
 
-    if ((bytes = send(sk.skHandle, buff, size, 0)) < 0) {
-        sk.s32Error = __ERROR__;
+    /* A closed peer must fail the call, not raise SIGPIPE */
+    if ((bytes = send(sk.skHandle, buff, size, MSG_NOSIGNAL)) < 0) {
+        socket_set_error(error, __ERROR__);
         OSAL_ERR("[%s] Send failed, %s\n", __FUNCTION__, __ERROR_STR__);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_recv(SOCKET_T &sk, char *buff, size_t size) {
+int socket_recv(SOCKET_T &sk, char *buff, size_t size, int32_t *error) {
     int bytes = 0;
 
     if (!socket_is_valid(sk)) {
@@ -276,14 +318,105 @@ int socket_recv(SOCKET_T &sk, char *buff, size_t size) {
     }
 
     if ((bytes = recv(sk.skHandle, buff, size, 0)) < 0) {
-        sk.s32Error = __ERROR__;
+        socket_set_error(error, __ERROR__);
         // OSAL_ERR("[%s] Receive failed, %s\n", __FUNCTION__, __ERROR_STR__);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t size) {
+/**
+ * @fn socket_sendv
+ * @brief Gather write, the elements of iov are sent in order with a single sendmsg() call
+ *
+ * @param sk
+ * @param iov       Array of buffers
+ * @param count     Number of elements in iov
+ * @return int      Number of bytes sent (may be less than the total size), -1 if failed
+ */
+int socket_sendv(SOCKET_T &sk, const SOCKET_IOV *iov, size_t count, int32_t *error) {
+    ssize_t bytes = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (!iov || count == 0 || count > IOV_MAX) {
+        OSAL_ERR("[%s] Invalid buffer\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    struct msghdr stMsg = {};
+    stMsg.msg_iov = const_cast<struct iovec *>(reinterpret_cast<const struct iovec *>(iov));
+    stMsg.msg_iovlen = count;
+    if ((bytes = sendmsg(sk.skHandle, &stMsg, MSG_NOSIGNAL)) < 0) {
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        if (s32Error != EAGAIN && s32Error != EWOULDBLOCK) {
+            OSAL_ERR("[%s] Send failed, %s\n", __FUNCTION__, __ERROR_STR__);
+        }
+        return RET_ERR;
+    }
+    return static_cast<int>(bytes);
+}
+
+/**
+ * @fn socket_recvv
+ * @brief Scatter read, received data fills the elements of iov in order with a single readv() call
+ *
+ * @param sk
+ * @param iov       Array of buffers
+ * @param count     Number of elements in iov
+ * @return int      Number of bytes received, 0 if peer closed, -1 if failed
+ */
+int socket_recvv(SOCKET_T &sk, const SOCKET_IOV *iov, size_t count, int32_t *error) {
+    ssize_t bytes = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (!iov || count == 0 || count > IOV_MAX) {
+        OSAL_ERR("[%s] Invalid buffer\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    if ((bytes = readv(sk.skHandle, reinterpret_cast<const struct iovec *>(iov), static_cast<int>(count))) < 0) {
+        socket_set_error(error, __ERROR__);
+        // OSAL_ERR("[%s] Receive failed, %s\n", __FUNCTION__, __ERROR_STR__);
+        return RET_ERR;
+    }
+    return static_cast<int>(bytes);
+}
+
+/**
+ * @fn socket_wait
+ * @brief Wait until the socket is readable and/or writable
+ *
+ * @param sk
+ * @param events        SOCKET_WAIT_READ and/or SOCKET_WAIT_WRITE
+ * @param timeout_ms    -1 waits without limit
+ * @param error         If not null, set to the error of this call when it fails
+ * @return int          1 if ready or in error (the next call reports it), 0 on timeout, -1 if failed
+ */
+int socket_wait(SOCKET_T &sk, int32_t events, int32_t timeout_ms, int32_t *error) {
+    struct pollfd stFd = {sk.skHandle, 0, 0};
+    int ret = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    stFd.events = static_cast<short>(((events & SOCKET_WAIT_READ) ? POLLIN : 0) | ((events & SOCKET_WAIT_WRITE) ? POLLOUT : 0));
+    if ((ret = poll(&stFd, 1, timeout_ms)) < 0) {
+        socket_set_error(error, __ERROR__);
+        return RET_ERR;
+    }
+    return (ret > 0 ? 1 : 0);
+}
+
+int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t size, int32_t *error) {
     int bytes = 0;
     socklen_t addrSize = 0;
 
@@ -305,14 +438,14 @@ int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t
     }
 
     if ((bytes = sendto(sk.skHandle, (void *)buff, size, 0, (sockaddr *)&sendaddr, addrSize)) < 0) {
-        sk.s32Error = __ERROR__;
+        socket_set_error(error, __ERROR__);
         OSAL_ERR("[%s] Send to failed, %s\n", __FUNCTION__, __ERROR_STR__);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size) {
+int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size, int32_t *error) {
     int bytes = 0;
     socklen_t addrSize = 0;
 
@@ -334,14 +467,14 @@ int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size
     }
 
     if ((bytes = recvfrom(sk.skHandle, (void *)buff, size, 0, (sockaddr *)&recvaddr, &addrSize)) < 0) {
-        sk.s32Error = __ERROR__;
+        socket_set_error(error, __ERROR__);
         // OSAL_ERR("[%s] Receive failed, %s\n", __FUNCTION__, __ERROR_STR__);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, const char *buff, size_t size) {
+int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, const char *buff, size_t size, int32_t *error) {
     int bytes = 0;
     socklen_t addrSize = 0;
     struct sockaddr_in stGroupSocket;
@@ -364,7 +497,7 @@ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, cons
      * Disable loopback so you do not receive your own datagrams.
      */
     if (setsockopt(sk.skHandle, IPPROTO_IP, IP_MULTICAST_LOOP, (char *)&loopch, sizeof(loopch)) < 0) {
-        sk.s32Error = __ERROR__;
+        socket_set_error(error, __ERROR__);
         OSAL_ERR("[%s] setting IP_MULTICAST_LOOP: failed, %s", __FUNCTION__, __ERROR_STR__);
         return RET_ERR;
     }
@@ -374,7 +507,7 @@ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, cons
      * multicast-capable interface.
      */
     if (setsockopt(sk.skHandle, IPPROTO_IP, IP_MULTICAST_IF, &sk.stAddrInet.Ip.v4, sizeof(sk.stAddrInet.Ip.v4)) < 0) {
-        sk.s32Error = __ERROR__;
+        socket_set_error(error, __ERROR__);
         OSAL_ERR("[%s] Setting local interface for multicast failed, %s\n", __FUNCTION__, __ERROR_STR__);
         return RET_ERR;
     }
@@ -384,13 +517,131 @@ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, cons
      * stGroupSocket sockaddr structure.
      */
     if (sendto(sk.skHandle, buff, size, 0, (struct sockaddr *)&stGroupSocket, sizeof(stGroupSocket)) < 0) {
-        sk.s32Error = __ERROR__;
+        socket_set_error(error, __ERROR__);
         OSAL_ERR("[%s] Sending datagram message failed, %s\n", __FUNCTION__, __ERROR_STR__);
         return RET_ERR;
     }
     return RET_OK;
 }
 
+/**
+ * @fn socket_multicast_membership
+ * @brief Add or drop an any-source (sourceip == nullptr) or source-specific group membership
+ *
+ * @param sk
+ * @param option        IP_ADD/DROP_MEMBERSHIP or IP_ADD/DROP_SOURCE_MEMBERSHIP
+ * @param groupip
+ * @param sourceip
+ * @param ifaceip       Local interface address, nullptr lets the kernel choose
+ * @return int
+ */
+static int socket_multicast_membership(SOCKET_T &sk, int option, const char *groupip, const char *sourceip, const char *ifaceip) {
+    int ret = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (groupip == nullptr) {
+        OSAL_ERR("[%s] Invalid group\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    if (sourceip == nullptr) {
+        struct ip_mreq stReq;
+        memset(&stReq, 0, sizeof(stReq));
+        stReq.imr_multiaddr.s_addr = inet_addr(groupip);
+        stReq.imr_interface.s_addr = (ifaceip != nullptr ? inet_addr(ifaceip) : htonl(INADDR_ANY));
+        ret = setsockopt(sk.skHandle, IPPROTO_IP, option, (char *)&stReq, sizeof(stReq));
+    } else {
+        struct ip_mreq_source stReq;
+        memset(&stReq, 0, sizeof(stReq));
+        stReq.imr_multiaddr.s_addr = inet_addr(groupip);
+        stReq.imr_sourceaddr.s_addr = inet_addr(sourceip);
+        stReq.imr_interface.s_addr = (ifaceip != nullptr ? inet_addr(ifaceip) : htonl(INADDR_ANY));
+        ret = setsockopt(sk.skHandle, IPPROTO_IP, option, (char *)&stReq, sizeof(stReq));
+    }
+    if (ret < 0) {
+        sk.s32Error = __ERROR__;
+        OSAL_ERR("[%s] Multicast membership %d of %s failed\n", __FUNCTION__, option, groupip);
+        return RET_ERR;
+    }
+    return RET_OK;
+}
+
+int socket_join_multicast(SOCKET_T &sk, const char *groupip, const char *ifaceip) {
+    return socket_multicast_membership(sk, IP_ADD_MEMBERSHIP, groupip, nullptr, ifaceip);
+}
+
+int socket_leave_multicast(SOCKET_T &sk, const char *groupip, const char *ifaceip) {
+    return socket_multicast_membership(sk, IP_DROP_MEMBERSHIP, groupip, nullptr, ifaceip);
+}
+
+int socket_join_source_multicast(SOCKET_T &sk, const char *groupip, const char *sourceip, const char *ifaceip) {
+    if (sourceip == nullptr) {
+        OSAL_ERR("[%s] Invalid source\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    return socket_multicast_membership(sk, IP_ADD_SOURCE_MEMBERSHIP, groupip, sourceip, ifaceip);
+}
+
+int socket_leave_source_multicast(SOCKET_T &sk, const char *groupip, const char *sourceip, const char *ifaceip) {
+    if (sourceip == nullptr) {
+        OSAL_ERR("[%s] Invalid source\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    return socket_multicast_membership(sk, IP_DROP_SOURCE_MEMBERSHIP, groupip, sourceip, ifaceip);
+}
+
+/**
+ * @fn socket_set_multicast_all
+ * @brief Linux delivers datagrams of every group joined by any socket on the host to all
+ *        sockets bound to the port (IP_MULTICAST_ALL). Disable it to receive only the
+ *        groups joined on this socket.
+ *
+ * @param sk
+ * @param enable
+ * @return int
+ */
+int socket_set_multicast_all(SOCKET_T &sk, int32_t enable) {
+    int value = (enable ? 1 : 0);
+    SOCKET_OPT stOpt = {IPPROTO_IP, IP_MULTICAST_ALL, &value, sizeof(value)};
+    return socket_set_option(sk, stOpt);
+}
+
+/**
+ * @fn socket_set_udp_shard_filter
+ * @brief Attach a socket filter that only queues datagrams whose 32-bit big endian key at
+ *        the given payload offset satisfies key % count == index. Datagrams of other shards
+ *        are dropped in the kernel before they are queued or wake the reader. Datagrams
+ *        too short to hold the key are dropped.
+ *
+ * @param sk
+ * @param offset        Key offset in the UDP payload
+ * @param count         Number of shards
+ * @param index         Shard of this socket
+ * @return int
+ */
+int socket_set_udp_shard_filter(SOCKET_T &sk, uint32_t offset, uint32_t count, uint32_t index) {
+    if (count == 0 || index >= count) {
+        OSAL_ERR("[%s] Invalid shard %u/%u\n", __FUNCTION__, index, count);
+        return RET_ERR;
+    }
+    struct sock_filter astCode[] = {
+        /* A = key, the filter sees the datagram from the UDP header on */
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(sizeof(struct udphdr)) + offset},
+        /* A %= count */
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, count},
+        /* keep if A == index */
+        {BPF_JMP | BPF_JEQ | BPF_K, 0, 1, index},
+        {BPF_RET | BPF_K, 0, 0, 0xFFFFFFFF},
+        {BPF_RET | BPF_K, 0, 0, 0},
+    };
+    struct sock_fprog stProg = {static_cast<unsigned short>(sizeof(astCode) / sizeof(astCode[0])), astCode};
+    SOCKET_OPT stOpt = {SOL_SOCKET, SO_ATTACH_FILTER, &stProg, sizeof(stProg)};
+    return socket_set_option(sk, stOpt);
+}
+
 int socket_set_recv_buff(SOCKET_T &sk, uint32_t size) {
     int32_t s32Size = static_cast<int32_t>(size);
     socklen_t len = sizeof(int32_t);
@@ -540,6 +791,214 @@ const char *socket_ip_v6_to_string(SOCKADDR_T &addr) {
     return strAddr;
 }
 
+/* How each field of SOCKET_PROFILE maps to a socket option */
+typedef struct __SocketProfileOpt_t {
+    int32_t SocketProfile_t::*pField;
+    int32_t s32Level;
+    int32_t s32Option;
+    int32_t s32TcpOnly;
+    int32_t s32Optional; /* A failure is only visible in the read back value */
+    int32_t s32Doubled;  /* The kernel reports twice the value set */
+} SocketProfileOpt_t;
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
+static const SocketProfileOpt_t s_astProfileOpts[] = {
+    {&SocketProfile_t::s32NoDelay, IPPROTO_TCP, TCP_NODELAY, 1, 0, 0},
+    {&SocketProfile_t::s32Cork, IPPROTO_TCP, TCP_CORK, 1, 0, 0},
+    {&SocketProfile_t::s32QuickAck, IPPROTO_TCP, TCP_QUICKACK, 1, 1, 0},
+    {&SocketProfile_t::s32BusyPollUs, SOL_SOCKET, SO_BUSY_POLL, 0, 1, 0},
+    {&SocketProfile_t::s32SendBuff, SOL_SOCKET, SO_SNDBUF, 0, 0, 1},
+    {&SocketProfile_t::s32RecvBuff, SOL_SOCKET, SO_RCVBUF, 0, 0, 1},
+};
+#define SOCKET_PROFILE_OPTS (sizeof(s_astProfileOpts) / sizeof(s_astProfileOpts[0]))
+
+static inline int socket_profile_opt_applies(const SOCKET_T &sk, const SocketProfileOpt_t &opt) {
+    return (!opt.s32TcpOnly || sk.s32SocketType == eSOCKET_TCP);
+}
+
+/**
+ * @fn socket_get_profile_preset
+ * @brief Option values of a predefined profile
+ *
+ * @param profile   eSocketProfile
+ * @return SOCKET_PROFILE
+ */
+SOCKET_PROFILE socket_get_profile_preset(int32_t profile) {
+    switch (profile) {
+    case eSOCKET_PROFILE_LOW_LATENCY:
+        return {1, 0, 1, 50, 32 * 1024, 32 * 1024};
+    case eSOCKET_PROFILE_BULK:
+        return {0, 1, -1, 0, 4 * 1024 * 1024, 4 * 1024 * 1024};
+    default:
+        return {0, 0, -1, 0, -1, -1};
+    }
+}
+
+/**
+ * @fn socket_get_profile
+ * @brief Read the current values of the profile options, -1 for options that do not
+ *        apply to the socket type or could not be read
+ *
+ * @param sk
+ * @param current
+ * @return int
+ */
+int socket_get_profile(SOCKET_T &sk, SOCKET_PROFILE &current) {
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    for (size_t i = 0; i < SOCKET_PROFILE_OPTS; i++) {
+        const SocketProfileOpt_t &opt = s_astProfileOpts[i];
+        int32_t s32Value = -1;
+        socklen_t len = sizeof(s32Value);
+        if (!socket_profile_opt_applies(sk, opt) || getsockopt(sk.skHandle, opt.s32Level, opt.s32Option, &s32Value, &len) < 0) {
+            s32Value = -1;
+        }
+        current.*opt.pField = s32Value;
+    }
+    return RET_OK;
+}
+
+/**
+ * @fn socket_apply_profile
+ * @brief Set a group of options as a whole, if a required option fails the ones
+ *        already set are restored. TCP options are skipped on other socket types,
+ *        quick ack and busy polling are best effort.
+ *
+ * Restoring a buffer size keeps it fixed, the kernel does not autotune a buffer
+ * once it was set explicitly.
+ *
+ * @param sk
+ * @param profile   Values to set, -1 leaves an option untouched
+ * @param applied   Values read back afterwards, i.e. what the kernel really uses
+ * @return int      0 if all required options were set, otherwise -1
+ */
+int socket_apply_profile(SOCKET_T &sk, const SOCKET_PROFILE &profile, SOCKET_PROFILE &applied) {
+    SOCKET_PROFILE stSaved;
+    uint32_t u32SetMask = 0;
+    int ret = RET_OK;
+
+    if (socket_get_profile(sk, stSaved) != RET_OK) {
+        return RET_ERR;
+    }
+
+    for (size_t i = 0; i < SOCKET_PROFILE_OPTS; i++) {
+        const SocketProfileOpt_t &opt = s_astProfileOpts[i];
+        int32_t s32Value = profile.*opt.pField;
+        if (s32Value < 0 || !socket_profile_opt_applies(sk, opt)) {
+            continue;
+        }
+        if (setsockopt(sk.skHandle, opt.s32Level, opt.s32Option, &s32Value, sizeof(s32Value)) < 0) {
+            if (opt.s32Optional) {
+                OSAL_INFO("[%s] Option %d not applied, %s\n", __FUNCTION__, opt.s32Option, __ERROR_STR__);
+                continue;
+            }
+            sk.s32Error = __ERROR__;
+            OSAL_ERR("[%s] Set option %d failed, %s\n", __FUNCTION__, opt.s32Option, __ERROR_STR__);
+            ret = RET_ERR;
+            break;
+        }
+        u32SetMask |= (1U << i);
+    }
+
+    if (ret != RET_OK) {
+        for (size_t i = 0; i < SOCKET_PROFILE_OPTS; i++) {
+            const SocketProfileOpt_t &opt = s_astProfileOpts[i];
+            int32_t s32Value = stSaved.*opt.pField;
+            if (!(u32SetMask & (1U << i)) || s32Value < 0) {
+                continue;
+            }
+            if (opt.s32Doubled) {
+                s32Value /= 2;
+            }
+            setsockopt(sk.skHandle, opt.s32Level, opt.s32Option, &s32Value, sizeof(s32Value));
+        }
+    }
+
+    socket_get_profile(sk, applied);
+    return ret;
+}
+
+/**
+ * @fn socket_flush_cork
+ * @brief Push out data held back by TCP_CORK, the socket stays corked
+ *
+ * @param sk
+ * @return int
+ */
+int socket_flush_cork(SOCKET_T &sk) {
+    int32_t s32Cork = 0;
+    socklen_t len = sizeof(s32Cork);
+
+    if (!socket_is_valid(sk) || sk.s32SocketType != eSOCKET_TCP) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (getsockopt(sk.skHandle, IPPROTO_TCP, TCP_CORK, &s32Cork, &len) < 0) {
+        sk.s32Error = __ERROR__;
+        OSAL_ERR("[%s] Get cork failed, %s\n", __FUNCTION__, __ERROR_STR__);
+        return RET_ERR;
+    }
+    if (!s32Cork) {
+        return RET_OK;
+    }
+    int32_t s32Off = 0;
+    if (setsockopt(sk.skHandle, IPPROTO_TCP, TCP_CORK, &s32Off, sizeof(s32Off)) < 0 ||
+        setsockopt(sk.skHandle, IPPROTO_TCP, TCP_CORK, &s32Cork, sizeof(s32Cork)) < 0) {
+        sk.s32Error = __ERROR__;
+        OSAL_ERR("[%s] Flush failed, %s\n", __FUNCTION__, __ERROR_STR__);
+        return RET_ERR;
+    }
+    return RET_OK;
+}
+
+/**
+ * @fn socket_set_reuse_port
+ * @brief Allow several sockets to bind the same address and port (SO_REUSEPORT),
+ *        the kernel spreads incoming connections/datagrams over the group
+ *
+ * @param sk
+ * @param enable
+ * @return int
+ */
+int socket_set_reuse_port(SOCKET_T &sk, int32_t enable) {
+    int value = (enable ? 1 : 0);
+    SOCKET_OPT stOpt = {SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)};
+    return socket_set_option(sk, stOpt);
+}
+
+/**
+ * @fn socket_set_reuse_port_cpu_steering
+ * @brief Attach a classic BPF program to the SO_REUSEPORT group which picks the socket
+ *        whose index equals the CPU that handled the packet. Socket N of the group should
+ *        therefore be served by a thread pinned to CPU N, the kernel falls back to hashing
+ *        when the index is out of range.
+ *
+ * @param sk
+ * @return int
+ */
+int socket_set_reuse_port_cpu_steering(SOCKET_T &sk) {
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    struct sock_filter astCode[] = {
+        /* A = cpu id */
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+        /* return A */
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    struct sock_fprog stProg = {static_cast<unsigned short>(sizeof(astCode) / sizeof(astCode[0])), astCode};
+    SOCKET_OPT stOpt = {SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &stProg, sizeof(stProg)};
+    return socket_set_option(sk, stOpt);
+#else
+    (void)sk;
+    OSAL_ERR("[%s] SO_ATTACH_REUSEPORT_CBPF is not supported\n", __FUNCTION__);
+    return RET_ERR;
+#endif
+}
+
 SOCKADDR_T socket_get_name(SOCKET_T &sk) {
     SOCKADDR_T addr;
     socklen_t len = 0;
@@ -557,4 +1016,31 @@ SOCKADDR_T socket_get_name(SOCKET_T &sk) {
     }
     return addr;
 }
+
+/**
+ * @fn socket_get_peer_cred
+ * @brief Get the credentials of the peer process of a connected local socket (SO_PEERCRED)
+ *
+ * @param sk
+ * @param cred
+ * @return int
+ */
+int socket_get_peer_cred(SOCKET_T &sk, SOCKET_CRED &cred) {
+    struct ucred stCred;
+    socklen_t len = sizeof(stCred);
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (getsockopt(sk.skHandle, SOL_SOCKET, SO_PEERCRED, &stCred, &len) < 0) {
+        sk.s32Error = __ERROR__;
+        OSAL_ERR("[%s] Get peer credentials failed, %s\n", __FUNCTION__, __ERROR_STR__);
+        return RET_ERR;
+    }
+    cred.s32Pid = static_cast<int32_t>(stCred.pid);
+    cred.u32Uid = static_cast<uint32_t>(stCred.uid);
+    cred.u32Gid = static_cast<uint32_t>(stCred.gid);
+    return RET_OK;
+}
 } // namespace ipc::core
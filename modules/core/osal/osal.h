@@ -120,21 +120,56 @@ typedef struct __SocketOption_t {
     size_t uSize;
 } SocketOption_t;
 
-#define SOCKET_T   Socket_t
-#define SOCKET_OPT SocketOption_t
+/* Scatter/gather element, layout compatible with POSIX struct iovec */
+typedef struct __SocketIoVec_t {
+    void *pBuffer;
+    size_t uSize;
+} SocketIoVec_t;
+
+/* Credentials of the process on the other end of a local socket */
+typedef struct __SocketCredential_t {
+    int32_t s32Pid;
+    uint32_t u32Uid;
+    uint32_t u32Gid;
+} SocketCredential_t;
+
+/* Options applied together by socket_apply_profile, -1 leaves an option untouched */
+typedef struct __SocketProfile_t {
+    int32_t s32NoDelay;    /* TCP_NODELAY */
+    int32_t s32Cork;       /* TCP_CORK, data is held back until a full segment or a flush */
+    int32_t s32QuickAck;   /* TCP_QUICKACK, not sticky, the kernel may return to delayed acks */
+    int32_t s32BusyPollUs; /* SO_BUSY_POLL, raising it needs CAP_NET_ADMIN */
+    int32_t s32SendBuff;   /* SO_SNDBUF, read back doubled and clamped by the kernel */
+    int32_t s32RecvBuff;   /* SO_RCVBUF, read back doubled and clamped by the kernel */
+} SocketProfile_t;
+
+#define SOCKET_T    Socket_t
+#define SOCKET_OPT  SocketOption_t
+#define SOCKET_IOV  SocketIoVec_t
+#define SOCKET_CRED SocketCredential_t
+#define SOCKET_PROFILE SocketProfile_t
 #define SOCKADDR_T SocketGenericIpAddr_t
 
 #define SOCKET_BLOCKING_MODE    0
 #define SOCKET_NONBLOCKING_MODE 1
 #define SOCKET_ADDR_V4          AF_INET
 #define SOCKET_ADDR_V6          AF_INET6
+#define SOCKET_WAIT_READ        0x1
+#define SOCKET_WAIT_WRITE       0x2
 
 typedef enum __eSocketType {
-    eSOCKET_HOST = 0,
+    eSOCKET_HOST = 0,    /* Local socket, message boundaries preserved (SOCK_SEQPACKET) */
     eSOCKET_TCP,
-    eSOCKET_UDP
+    eSOCKET_UDP,
+    eSOCKET_HOST_STREAM, /* Local socket, byte stream (SOCK_STREAM) */
 } eSocketType;
 
+typedef enum __eSocketProfile {
+    eSOCKET_PROFILE_DEFAULT = 0, /* Nagle on, no corking, no busy polling, buffers untouched */
+    eSOCKET_PROFILE_LOW_LATENCY, /* No Nagle, quick acks, busy polling, small buffers */
+    eSOCKET_PROFILE_BULK,        /* Corked writes, large buffers */
+} eSocketProfile;
+
 typedef enum __eSocketMode {
     eSOCKET_CLIENT = 0,
     eSOCKET_SERVER,
@@ -1,215 +1,589 @@
 #include "timer.h"
-#include "ipc_mutex.h"
 #include "ipc_thread.h"
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string.h>
 #include <string>
-#include <vector>
+#include <thread>
+#include <unordered_map>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
 
 namespace ipc::core {
-#define TIMER_TICK        1000
-#define clock_now()       std::chrono::high_resolution_clock::now()
-#define clock_duration(x) std::chrono::duration_cast<std::chrono::microseconds>(x)
+/*
+ * Timers live in a hierarchical wheel of TIMER_WHEEL_LEVELS levels, TIMER_WHEEL_SLOTS
+ * slots each, with a 1 ms tick. Level 0 holds the next 64 ms, each higher level covers
+ * 64 times the span of the one below and is cascaded down when the wheel reaches it.
+ * The timer thread sleeps until the next occupied slot, on Linux on a timerfd.
+ */
+#define TIMER_WHEEL_BITS   6
+#define TIMER_WHEEL_SLOTS  (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_NO_EXPIRY    UINT64_MAX
+#define clock_now()        std::chrono::steady_clock::now()
 
-struct timer_wrap_t {
+struct timer_node_t {
     TIMER_T timer;
-    int tick;
+    uint64_t expires; /* Absolute tick */
     int start;
+    int queued; /* A callback is waiting for the dispatch thread */
+    int level;  /* -1 when not in the wheel */
+    int slot;
+    timer_node_t *prev;
+    timer_node_t *next;
+};
+
+struct timer_dispatch_t {
+    int id;
+    TIMER_Callback fnc;
+    void *param;
 };
 
 struct timer_manager_t {
-    MUTEX_t mtx;
-    std::vector<timer_wrap_t> timers;
+    std::mutex mtx;
+    std::unordered_map<int, timer_node_t *> timers;
+    timer_node_t *wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t occupied[TIMER_WHEEL_LEVELS]; /* One bit per non-empty slot */
+    uint64_t tick;                         /* Every expiry up to this tick was handled */
+    uint64_t armed;                        /* Tick the timer thread sleeps until */
+    int index;
+
+    /* Callbacks run on the dispatch thread, never under the lock or on the timer thread */
+    std::deque<timer_dispatch_t> pending;
+    std::condition_variable dispatch_cond;
+    std::condition_variable idle_cond;
+    std::thread::id dispatch_thread;
+    int running_id;
+
+#if defined(__linux__)
+    int timer_fd;
+    int wake_fd;
+#else
+    std::condition_variable wake_cond;
+    int wake;
+#endif
 };
 
 /* TIMER MANAGER OBJECTS */
 static THREAD_T base_timer_thread;
-static timer_manager_t timer_manager;
+static THREAD_T base_dispatch_thread;
+static std::once_flag timer_once;
 static int timer_initialized = 0;
-static int timer_index = 0;
-static auto timer_begin_time = clock_now();
+static const auto timer_begin_time = clock_now();
+
+/* Never destroyed, timers may still be terminated while statics are torn down */
+static timer_manager_t &manager() {
+    static timer_manager_t *mgr = new timer_manager_t();
+    return *mgr;
+}
+
+static uint64_t timer_now_tick() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(clock_now() - timer_begin_time).count());
+}
+
+/* Rounded up, an interval counted from it never ends before the real interval has passed */
+static uint64_t timer_start_tick() {
+    return static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(clock_now() - timer_begin_time).count());
+}
+
+/**
+ * @fn timer_wake
+ * @brief Wake the timer thread so it recomputes its sleep, called with the lock held
+ */
+static void timer_wake(timer_manager_t &mgr) {
+#if defined(__linux__)
+    uint64_t one = 1;
+    if (write(mgr.wake_fd, &one, sizeof(one)) < 0) {
+        /* Counter saturated, the thread is woken anyway */
+    }
+#else
+    mgr.wake = 1;
+    mgr.wake_cond.notify_one();
+#endif
+}
+
+/**
+ * @fn timer_link
+ * @brief Put a node in the slot its expiry falls into, O(1)
+ */
+static void timer_link(timer_manager_t &mgr, timer_node_t *node) {
+    uint64_t expires = (node->expires > mgr.tick ? node->expires : mgr.tick);
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1) {
+        int shift = TIMER_WHEEL_BITS * level;
+        if ((expires >> shift) - (mgr.tick >> shift) < TIMER_WHEEL_SLOTS) {
+            break;
+        }
+        level++;
+    }
+
+    int shift = TIMER_WHEEL_BITS * level;
+    uint64_t span = (expires >> shift) - (mgr.tick >> shift);
+    if (span >= TIMER_WHEEL_SLOTS) {
+        /* Beyond the last level, park it in the furthest slot and place it again later */
+        span = TIMER_WHEEL_SLOTS - 1;
+    }
+    int slot = static_cast<int>(((mgr.tick >> shift) + span) & TIMER_WHEEL_MASK);
+
+    node->level = level;
+    node->slot = slot;
+    node->prev = NULL;
+    node->next = mgr.wheel[level][slot];
+    if (node->next != NULL) {
+        node->next->prev = node;
+    }
+    mgr.wheel[level][slot] = node;
+    mgr.occupied[level] |= (1ULL << slot);
+}
+
+/**
+ * @fn timer_unlink
+ * @brief Take a node out of the wheel, O(1)
+ */
+static void timer_unlink(timer_manager_t &mgr, timer_node_t *node) {
+    if (node->level < 0) {
+        return;
+    }
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        mgr.wheel[node->level][node->slot] = node->next;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    }
+    if (mgr.wheel[node->level][node->slot] == NULL) {
+        mgr.occupied[node->level] &= ~(1ULL << node->slot);
+    }
+    node->level = -1;
+    node->prev = NULL;
+    node->next = NULL;
+}
+
+static void timer_schedule(timer_manager_t &mgr, timer_node_t *node, uint64_t now) {
+    timer_unlink(mgr, node);
+    node->expires = now + static_cast<uint64_t>(node->timer.interval);
+    timer_link(mgr, node);
+    if (node->expires < mgr.armed) {
+        timer_wake(mgr);
+    }
+}
+
+static int timer_ctz(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+/* Distance from the slot after start to the next occupied one, 0 if none */
+static uint64_t timer_next_slot(uint64_t occupied, int start) {
+    if (occupied == 0) {
+        return 0;
+    }
+    int from = (start + 1) & TIMER_WHEEL_MASK;
+    uint64_t rotated = (from == 0 ? occupied : ((occupied >> from) | (occupied << (TIMER_WHEEL_SLOTS - from))));
+    return static_cast<uint64_t>(timer_ctz(rotated)) + 1;
+}
+
+/**
+ * @fn timer_next_expiry
+ * @brief Tick of the next expiry or cascade, TIMER_NO_EXPIRY when the wheel is empty
+ */
+static uint64_t timer_next_expiry(timer_manager_t &mgr) {
+    uint64_t next = TIMER_NO_EXPIRY;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        int shift = TIMER_WHEEL_BITS * level;
+        uint64_t distance = timer_next_slot(mgr.occupied[level], static_cast<int>((mgr.tick >> shift) & TIMER_WHEEL_MASK));
+        if (distance != 0) {
+            uint64_t at = ((mgr.tick >> shift) + distance) << shift;
+            if (at < next) {
+                next = at;
+            }
+        }
+    }
+    return next;
+}
+
+/**
+ * @fn timer_process
+ * @brief Cascade the higher levels reaching this tick and fire level 0, called at mgr.tick
+ */
+static void timer_process(timer_manager_t &mgr, std::deque<timer_dispatch_t> &fired) {
+    for (int level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+        int shift = TIMER_WHEEL_BITS * level;
+        if ((mgr.tick & ((1ULL << shift) - 1)) != 0) {
+            continue;
+        }
+        int slot = static_cast<int>((mgr.tick >> shift) & TIMER_WHEEL_MASK);
+        timer_node_t *node = mgr.wheel[level][slot];
+        mgr.wheel[level][slot] = NULL;
+        mgr.occupied[level] &= ~(1ULL << slot);
+        while (node != NULL) {
+            timer_node_t *next = node->next;
+            node->level = -1;
+            timer_link(mgr, node);
+            node = next;
+        }
+    }
+
+    int slot = static_cast<int>(mgr.tick & TIMER_WHEEL_MASK);
+    timer_node_t *node = mgr.wheel[0][slot];
+    mgr.wheel[0][slot] = NULL;
+    mgr.occupied[0] &= ~(1ULL << slot);
+    while (node != NULL) {
+        timer_node_t *next = node->next;
+        node->level = -1;
+        if (node->expires > mgr.tick) {
+            /* Parked in the furthest slot, not due yet */
+            timer_link(mgr, node);
+        } else {
+            if (node->queued == 0) {
+                /* A slow callback is not queued again behind itself */
+                node->queued = 1;
+                fired.push_back({node->timer.id, node->timer.fnc, node->timer.param});
+            }
+            node->expires = mgr.tick + static_cast<uint64_t>(node->timer.interval);
+            timer_link(mgr, node);
+        }
+        node = next;
+    }
+}
+
+/**
+ * @fn timer_advance
+ * @brief Move the wheel to now, jumping straight to the occupied slots
+ */
+static void timer_advance(timer_manager_t &mgr, uint64_t now, std::deque<timer_dispatch_t> &fired) {
+    while (mgr.tick < now) {
+        uint64_t next = timer_next_expiry(mgr);
+        if (next > now) {
+            mgr.tick = now;
+            break;
+        }
+        mgr.tick = next;
+        timer_process(mgr, fired);
+    }
+}
+
+/**
+ * @fn timer_sleep
+ * @brief Sleep until the tick is reached or the thread is woken, called without the lock
+ */
+static void timer_sleep(timer_manager_t &mgr, uint64_t until) {
+#if defined(__linux__)
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (until != TIMER_NO_EXPIRY) {
+        auto deadline = timer_begin_time + std::chrono::milliseconds(until);
+        auto remain = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - clock_now()).count();
+        if (remain <= 0) {
+            return;
+        }
+        spec.it_value.tv_sec = static_cast<time_t>(remain / 1000000000LL);
+        spec.it_value.tv_nsec = static_cast<long>(remain % 1000000000LL);
+    }
+    if (timerfd_settime(mgr.timer_fd, 0, &spec, NULL) < 0) {
+        OSAL_ERR("[%s] timerfd_settime failed, %d\n", __FUNCTION__, __ERROR__);
+    }
+
+    struct pollfd fds[2];
+    fds[0].fd = mgr.timer_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = mgr.wake_fd;
+    fds[1].events = POLLIN;
+    if (poll(fds, 2, -1) > 0) {
+        uint64_t count = 0;
+        if ((fds[0].revents & POLLIN) && read(mgr.timer_fd, &count, sizeof(count)) < 0) {
+            /* Spurious, rearmed on the next turn */
+        }
+        if ((fds[1].revents & POLLIN) && read(mgr.wake_fd, &count, sizeof(count)) < 0) {
+            /* Already drained */
+        }
+    }
+#else
+    std::unique_lock<std::mutex> lock(mgr.mtx);
+    if (until == TIMER_NO_EXPIRY) {
+        mgr.wake_cond.wait(lock, [&mgr] { return mgr.wake != 0; });
+    } else {
+        mgr.wake_cond.wait_until(lock, timer_begin_time + std::chrono::milliseconds(until), [&mgr] { return mgr.wake != 0; });
+    }
+    mgr.wake = 0;
+#endif
+}
 
 /**
  * @fn timer_run
- * @brief Timer thread loop base
+ * @brief Timer thread loop, sleeps until the next expiry
  *
  * @param param
  * @return void*
  */
 static TASK_RET timer_run(TASK_ARG param) {
+    timer_manager_t &mgr = *static_cast<timer_manager_t *>(param);
+    std::deque<timer_dispatch_t> fired;
     while (true) {
-
-#if defined(WIN32) || defined(_WIN32)
-        while (clock_duration(clock_now() - timer_begin_time).count() < TIMER_TICK) {}
-        timer_begin_time = clock_now();
-#else
-        ipc::core::thread_delay(1);
-#endif
-
-        mutex_lock(timer_manager.mtx);
-        for (timer_wrap_t &wrapper : timer_manager.timers) {
-            if (!wrapper.start) {
-                continue;
-            }
-            wrapper.tick++;
-            if (wrapper.tick >= wrapper.timer.interval) {
-                wrapper.tick = 0;
-                if (wrapper.timer.fnc) {
-                    wrapper.timer.fnc(wrapper.timer.param);
+        uint64_t until = TIMER_NO_EXPIRY;
+        {
+            std::unique_lock<std::mutex> lock(mgr.mtx);
+            timer_advance(mgr, timer_now_tick(), fired);
+            until = timer_next_expiry(mgr);
+            mgr.armed = until;
+            if (!fired.empty()) {
+                for (auto &item : fired) {
+                    mgr.pending.push_back(item);
                 }
+                fired.clear();
+                mgr.dispatch_cond.notify_one();
             }
         }
-        mutex_unlock(timer_manager.mtx);
+        timer_sleep(mgr, until);
     }
     return nullptr;
 }
 
 /**
- * @fn timer_initialize
- * @brief Initialize timer loop
+ * @fn timer_dispatch
+ * @brief Dispatch thread loop, runs the callbacks of fired timers outside the lock
  *
- * @return int
+ * @param param
+ * @return void*
  */
-int timer_initialize() {
-    if (mutex_create(timer_manager.mtx) < 0) {
-        return RET_ERR;
+static TASK_RET timer_dispatch(TASK_ARG param) {
+    timer_manager_t &mgr = *static_cast<timer_manager_t *>(param);
+    std::unique_lock<std::mutex> lock(mgr.mtx);
+    mgr.dispatch_thread = std::this_thread::get_id();
+    while (true) {
+        mgr.dispatch_cond.wait(lock, [&mgr] { return !mgr.pending.empty(); });
+        timer_dispatch_t item = mgr.pending.front();
+        mgr.pending.pop_front();
+
+        /* Stopped or terminated after it fired */
+        auto it = mgr.timers.find(item.id);
+        if (it == mgr.timers.end()) {
+            continue;
+        }
+        it->second->queued = 0;
+        if (!it->second->start || !item.fnc) {
+            continue;
+        }
+
+        mgr.running_id = item.id;
+        lock.unlock();
+        item.fnc(item.param);
+        lock.lock();
+        mgr.running_id = 0;
+        mgr.idle_cond.notify_all();
     }
+    return nullptr;
+}
 
-    if (thread_create(base_timer_thread, "__timer_thread", timer_run, &timer_manager, 0) != 0) {
-        return RET_ERR;
+/**
+ * @fn timer_wait_callback
+ * @brief Wait for a running callback of the timer, unless called from that callback
+ */
+static void timer_wait_callback(timer_manager_t &mgr, std::unique_lock<std::mutex> &lock, int id) {
+    if (std::this_thread::get_id() != mgr.dispatch_thread) {
+        mgr.idle_cond.wait(lock, [&mgr, id] { return mgr.running_id != id; });
+    }
+}
+
+static timer_node_t *timer_find(timer_manager_t &mgr, const TIMER_T &timer) {
+    auto it = mgr.timers.find(timer.id);
+    return (it != mgr.timers.end() ? it->second : NULL);
+}
+
+static void timer_setup() {
+    timer_manager_t &mgr = manager();
+    memset(mgr.wheel, 0, sizeof(mgr.wheel));
+    memset(mgr.occupied, 0, sizeof(mgr.occupied));
+    mgr.tick = timer_now_tick();
+    mgr.armed = TIMER_NO_EXPIRY;
+    mgr.index = 0;
+    mgr.running_id = 0;
+
+#if defined(__linux__)
+    mgr.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    mgr.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mgr.timer_fd < 0 || mgr.wake_fd < 0) {
+        OSAL_ERR("[%s] timerfd/eventfd failed, %d\n", __FUNCTION__, __ERROR__);
+        return;
+    }
+#else
+    mgr.wake = 0;
+#endif
+
+    if (thread_create(base_dispatch_thread, "__timer_dispatch", timer_dispatch, &mgr, 0) != 0) {
+        return;
+    }
+    thread_run(base_dispatch_thread);
+    thread_detach(base_dispatch_thread);
+
+    if (thread_create(base_timer_thread, "__timer_thread", timer_run, &mgr, 0) != 0) {
+        return;
     }
     thread_run(base_timer_thread);
     thread_detach(base_timer_thread);
-    return RET_OK;
+    timer_initialized = 1;
+}
+
+/**
+ * @fn timer_initialize
+ * @brief Initialize the timer and dispatch threads, once per process
+ *
+ * @return int
+ */
+int timer_initialize() {
+    std::call_once(timer_once, timer_setup);
+    return (timer_initialized ? RET_OK : RET_ERR);
 }
 
 /**
  * @fn timer_create
- * @brief Create Timer using thread base
+ * @brief Create a periodic timer on the timer wheel
  *
  * @param interval  Timer interval in ms
- * @param fnc       Callback when timeout
+ * @param fnc       Callback when timeout, runs on the timer dispatch thread
  * @param name      Timer name
  * @param start     Start after create
  * @return TIMER_T
  */
 TIMER_T timer_create(int interval, TIMER_Callback fnc, void *param, const char *name, int start) {
-    timer_wrap_t wrapper;
+    TIMER_T timer;
 
-    memset(&wrapper, 0, sizeof(wrapper));
+    memset(&timer, 0, sizeof(timer));
 
-    if (timer_initialized == 0) {
-        if (timer_initialize() < 0) {
-            return wrapper.timer;
-        }
-        else {
-            timer_initialized = 1;
-        }
+    if (timer_initialize() < 0) {
+        return timer;
     }
 
     if (interval <= 0 || !fnc) {
-        return wrapper.timer;
+        return timer;
     }
 
-    wrapper.tick = 0;
-    wrapper.start = start;
-    wrapper.timer.fnc = fnc;
-    wrapper.timer.interval = interval;
-    wrapper.timer.param = param;
-    wrapper.timer.id = ++timer_index;
+    timer.fnc = fnc;
+    timer.interval = interval;
+    timer.param = param;
 
     if (name) {
-        strncpy(wrapper.timer.name, name, sizeof(wrapper.timer.name));
+        strncpy(timer.name, name, sizeof(timer.name) - 1);
     }
 
-    mutex_lock(timer_manager.mtx);
-    timer_manager.timers.push_back(wrapper);
-    mutex_unlock(timer_manager.mtx);
+    timer_manager_t &mgr = manager();
+    timer_node_t *node = new timer_node_t();
+    std::unique_lock<std::mutex> lock(mgr.mtx);
+    timer.id = ++mgr.index;
+    node->timer = timer;
+    node->start = start;
+    node->queued = 0;
+    node->level = -1;
+    mgr.timers[timer.id] = node;
+    if (start) {
+        timer_schedule(mgr, node, timer_start_tick());
+    }
 
-    return wrapper.timer;
+    return timer;
 }
 
 /**
  * @fn timer_start
- * @brief
+ * @brief Start or restart a timer, the first expiry is one interval from now, never earlier
  *
  * @param timer
  * @return int
  */
 int timer_start(TIMER_T &timer) {
-    int ret = -1;
-    mutex_lock(timer_manager.mtx);
-    for (auto &wrapper : timer_manager.timers) {
-        if (timer.id == wrapper.timer.id) {
-            wrapper.start = 1;
-            ret = 0;
-            break;
-        }
+    timer_manager_t &mgr = manager();
+    std::unique_lock<std::mutex> lock(mgr.mtx);
+    timer_node_t *node = timer_find(mgr, timer);
+    if (node == NULL) {
+        return RET_ERR;
     }
-    mutex_unlock(timer_manager.mtx);
-    return ret;
+    node->start = 1;
+    timer_schedule(mgr, node, timer_start_tick());
+    return RET_OK;
 }
 
 /**
  * @fn timer_stop
- * @brief
+ * @brief Stop a timer, a running callback is waited for
  *
  * @param timer
  * @return int
  */
 int timer_stop(TIMER_T &timer) {
-    int ret = -1;
-    mutex_lock(timer_manager.mtx);
-    for (auto &wrapper : timer_manager.timers) {
-        if (timer.id == wrapper.timer.id) {
-            wrapper.start = 0;
-            ret = 0;
-            break;
-        }
+    timer_manager_t &mgr = manager();
+    std::unique_lock<std::mutex> lock(mgr.mtx);
+    timer_node_t *node = timer_find(mgr, timer);
+    if (node == NULL) {
+        return RET_ERR;
     }
-    mutex_unlock(timer_manager.mtx);
-    return ret;
+    node->start = 0;
+    timer_unlink(mgr, node);
+    timer_wait_callback(mgr, lock, timer.id);
+    return RET_OK;
 }
 
 /**
  * @fn timer_set_initerval
- * @brief
+ * @brief Change the interval, a running timer restarts from now
  *
  * @param timer
  * @param interval
  * @return int
  */
 int timer_set_initerval(TIMER_T &timer, int interval) {
-    int ret = -1;
-    mutex_lock(timer_manager.mtx);
-    for (auto &wrapper : timer_manager.timers) {
-        if (timer.id == wrapper.timer.id) {
-            wrapper.timer.interval = interval;
-            break;
-        }
+    if (interval <= 0) {
+        return RET_ERR;
+    }
+    timer_manager_t &mgr = manager();
+    std::unique_lock<std::mutex> lock(mgr.mtx);
+    timer_node_t *node = timer_find(mgr, timer);
+    if (node == NULL) {
+        return RET_ERR;
     }
-    mutex_unlock(timer_manager.mtx);
-    return ret;
+    node->timer.interval = interval;
+    timer.interval = interval;
+    if (node->start) {
+        timer_schedule(mgr, node, timer_start_tick());
+    }
+    return RET_OK;
 }
 
 /**
  * @fn timer_terminate
- * @brief
+ * @brief Delete a timer, a running callback is waited for
  *
  * @param timer
  * @return int
  */
 int timer_terminate(TIMER_T &timer) {
-    int ret = -1;
-    mutex_lock(timer_manager.mtx);
-    for (auto i = timer_manager.timers.begin(); i != timer_manager.timers.end(); i++) {
-        if (timer.id == i->timer.id) {
-            timer_manager.timers.erase(i);
-            break;
-        }
+    timer_manager_t &mgr = manager();
+    std::unique_lock<std::mutex> lock(mgr.mtx);
+    timer_node_t *node = timer_find(mgr, timer);
+    if (node == NULL) {
+        return RET_ERR;
     }
-    mutex_unlock(timer_manager.mtx);
-    return ret;
+    timer_unlink(mgr, node);
+    mgr.timers.erase(timer.id);
+    delete node;
+    timer_wait_callback(mgr, lock, timer.id);
+    return RET_OK;
 }
-} // namespace ipc::core
\ No newline at end of file
+} // namespace ipc::core
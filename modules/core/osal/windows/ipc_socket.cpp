@@ -6,6 +6,13 @@ static inline int socket_is_valid(SOCKET_T &sk) {
     return (sk.skHandle <= 0 ? 0 : 1);
 }
 
+/* Data path calls run on several threads at once, so they report errors per call, not in sk */
+static inline void socket_set_error(int32_t *error, int32_t value) {
+    if (error) {
+        *error = value;
+    }
+}
+
 SOCKET_T socket_create(int32_t sockettype, int blockmode, int addrfamily) {
     SOCKET_T stSocket;
     int domain = (addrfamily == SOCKET_ADDR_V4 ? AF_INET : AF_INET6);
@@ -16,9 +23,12 @@ SOCKET_T socket_create(int32_t sockettype, int blockmode, int addrfamily) {
 
     if (sockettype == eSOCKET_HOST) {
         domain = AF_UNIX;
+    } else if (sockettype == eSOCKET_HOST_STREAM) {
+        domain = AF_UNIX;
+        type = SOCK_STREAM;
     } else if (sockettype == eSOCKET_TCP) {
         type = SOCK_STREAM;
-    } else if (sockettype = eSOCKET_UDP) {
+    } else if (sockettype == eSOCKET_UDP) {
         type = SOCK_DGRAM;
     } else {
         OSAL_ERR("[%s] Unsupport socket type %d\n", __FUNCTION__, sockettype);
@@ -212,7 +222,7 @@ SOCKET_T socket_accept(SOCKET_T &sk) {
     return stSocket;
 }
 
-int socket_send(SOCKET_T &sk, const char *buff, size_t size) {
+int socket_send(SOCKET_T &sk, const char *buff, size_t size, int32_t *error) {
     int bytes = 0;
 
     if (!socket_is_valid(sk)) {
@@ -225,14 +235,15 @@ int socket_send(SOCKET_T &sk, const char *buff, size_t size) {
     }
 
     if ((bytes = send(sk.skHandle, buff, size, 0)) < 0) {
-        sk.s32Error = __ERROR__;
-        OSAL_ERR("[%s] Send failed, %d\n", __FUNCTION__, sk.s32Error);
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        OSAL_ERR("[%s] Send failed, %d\n", __FUNCTION__, s32Error);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_recv(SOCKET_T &sk, char *buff, size_t size) {
+int socket_recv(SOCKET_T &sk, char *buff, size_t size, int32_t *error) {
     int bytes = 0;
 
     if (!socket_is_valid(sk)) {
@@ -245,14 +256,91 @@ int socket_recv(SOCKET_T &sk, char *buff, size_t size) {
     }
 
     if ((bytes = recv(sk.skHandle, buff, size, 0)) < 0) {
-        sk.s32Error = __ERROR__;
-        // OSAL_ERR("[%s] Receive failed, %d\n", __FUNCTION__, sk.s32Error);
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        // OSAL_ERR("[%s] Receive failed, %d\n", __FUNCTION__, s32Error);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t size) {
+/* WSABUF array used by the scatter/gather calls, larger requests are rejected */
+#define SOCKET_IOV_MAX 64
+
+int socket_sendv(SOCKET_T &sk, const SOCKET_IOV *iov, size_t count, int32_t *error) {
+    WSABUF buffers[SOCKET_IOV_MAX];
+    DWORD bytes = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (!iov || count == 0 || count > SOCKET_IOV_MAX) {
+        OSAL_ERR("[%s] Invalid buffer\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        buffers[i].buf = static_cast<CHAR *>(iov[i].pBuffer);
+        buffers[i].len = static_cast<ULONG>(iov[i].uSize);
+    }
+
+    if (WSASend(sk.skHandle, buffers, static_cast<DWORD>(count), &bytes, 0, NULL, NULL) != 0) {
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        OSAL_ERR("[%s] Send failed, %d\n", __FUNCTION__, s32Error);
+        return RET_ERR;
+    }
+    return static_cast<int>(bytes);
+}
+
+int socket_recvv(SOCKET_T &sk, const SOCKET_IOV *iov, size_t count, int32_t *error) {
+    WSABUF buffers[SOCKET_IOV_MAX];
+    DWORD bytes = 0;
+    DWORD flags = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (!iov || count == 0 || count > SOCKET_IOV_MAX) {
+        OSAL_ERR("[%s] Invalid buffer\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        buffers[i].buf = static_cast<CHAR *>(iov[i].pBuffer);
+        buffers[i].len = static_cast<ULONG>(iov[i].uSize);
+    }
+
+    if (WSARecv(sk.skHandle, buffers, static_cast<DWORD>(count), &bytes, &flags, NULL, NULL) != 0) {
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        // OSAL_ERR("[%s] Receive failed, %d\n", __FUNCTION__, s32Error);
+        return RET_ERR;
+    }
+    return static_cast<int>(bytes);
+}
+
+int socket_wait(SOCKET_T &sk, int32_t events, int32_t timeout_ms, int32_t *error) {
+    WSAPOLLFD stFd = {};
+    int ret = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    stFd.fd = sk.skHandle;
+    stFd.events = static_cast<SHORT>(((events & SOCKET_WAIT_READ) ? POLLRDNORM : 0) | ((events & SOCKET_WAIT_WRITE) ? POLLWRNORM : 0));
+    if ((ret = WSAPoll(&stFd, 1, timeout_ms)) < 0) {
+        socket_set_error(error, __ERROR__);
+        return RET_ERR;
+    }
+    return (ret > 0 ? 1 : 0);
+}
+
+int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t size, int32_t *error) {
     int bytes = 0;
     socklen_t addrSize = 0;
 
@@ -272,14 +360,15 @@ int socket_send_to(SOCKET_T &sk, SOCKADDR_T &sendaddr, const char *buff, size_t
     }
 
     if ((bytes = sendto(sk.skHandle, buff, size, 0, (sockaddr *)&sendaddr, addrSize)) < 0) {
-        sk.s32Error = __ERROR__;
-        OSAL_ERR("[%s] Send to failed, %d\n", __FUNCTION__, sk.s32Error);
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        OSAL_ERR("[%s] Send to failed, %d\n", __FUNCTION__, s32Error);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size) {
+int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size, int32_t *error) {
     int bytes = 0;
     socklen_t addrSize = 0;
 
@@ -299,14 +388,15 @@ int socket_recv_from(SOCKET_T &sk, SOCKADDR_T &recvaddr, char *buff, size_t size
     }
 
     if ((bytes = recvfrom(sk.skHandle, buff, size, 0, (sockaddr *)&recvaddr, &addrSize)) < 0) {
-        sk.s32Error = __ERROR__;
-        // OSAL_ERR("[%s] Receive failed, %d\n", __FUNCTION__, sk.s32Error);
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        // OSAL_ERR("[%s] Receive failed, %d\n", __FUNCTION__, s32Error);
         return RET_ERR;
     }
     return bytes;
 }
 
-int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, const char *buff, size_t size) {
+int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, const char *buff, size_t size, int32_t *error) {
     int bytes = 0;
     socklen_t addrSize = 0;
     struct sockaddr_in stGroupSocket;
@@ -329,8 +419,9 @@ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, cons
      * Disable loopback so you do not receive your own datagrams.
      */
     if (setsockopt(sk.skHandle, IPPROTO_IP, IP_MULTICAST_LOOP, (char *)&loopch, sizeof(loopch)) < 0) {
-        sk.s32Error = __ERROR__;
-        OSAL_ERR("[%s] setting IP_MULTICAST_LOOP: failed, %d", __FUNCTION__, sk.s32Error);
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        OSAL_ERR("[%s] setting IP_MULTICAST_LOOP: failed, %d", __FUNCTION__, s32Error);
         return RET_ERR;
     }
     /*
@@ -339,8 +430,9 @@ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, cons
      * multicast-capable interface.
      */
     if (setsockopt(sk.skHandle, IPPROTO_IP, IP_MULTICAST_IF, (char *)&sk.stAddrInet.Ip.v4, sizeof(sk.stAddrInet.Ip.v4)) < 0) {
-        sk.s32Error = __ERROR__;
-        OSAL_ERR("[%s] Setting local interface for multicast failed, %d\n", __FUNCTION__, sk.s32Error);
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        OSAL_ERR("[%s] Setting local interface for multicast failed, %d\n", __FUNCTION__, s32Error);
         return RET_ERR;
     }
 
@@ -349,13 +441,99 @@ int socket_send_multicast(SOCKET_T &sk, const char *groupip, uint16_t port, cons
      * stGroupSocket sockaddr structure.
      */
     if (sendto(sk.skHandle, buff, size, 0, (struct sockaddr *)&stGroupSocket, sizeof(stGroupSocket)) < 0) {
+        int32_t s32Error = __ERROR__;
+        socket_set_error(error, s32Error);
+        OSAL_ERR("[%s] Sending datagram message failed, %d\n", __FUNCTION__, s32Error);
+        return RET_ERR;
+    }
+    return RET_OK;
+}
+
+/**
+ * @fn socket_multicast_membership
+ * @brief Add or drop an any-source (sourceip == nullptr) or source-specific group membership
+ *
+ * @param sk
+ * @param option        IP_ADD/DROP_MEMBERSHIP or IP_ADD/DROP_SOURCE_MEMBERSHIP
+ * @param groupip
+ * @param sourceip
+ * @param ifaceip       Local interface address, nullptr lets the kernel choose
+ * @return int
+ */
+static int socket_multicast_membership(SOCKET_T &sk, int option, const char *groupip, const char *sourceip, const char *ifaceip) {
+    int ret = 0;
+
+    if (!socket_is_valid(sk)) {
+        OSAL_ERR("[%s] Invalid socket\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    if (groupip == nullptr) {
+        OSAL_ERR("[%s] Invalid group\n", __FUNCTION__);
+        return RET_ERR;
+    }
+
+    if (sourceip == nullptr) {
+        struct ip_mreq stReq;
+        memset(&stReq, 0, sizeof(stReq));
+        stReq.imr_multiaddr.s_addr = inet_addr(groupip);
+        stReq.imr_interface.s_addr = (ifaceip != nullptr ? inet_addr(ifaceip) : htonl(INADDR_ANY));
+        ret = setsockopt(sk.skHandle, IPPROTO_IP, option, (char *)&stReq, sizeof(stReq));
+    } else {
+        struct ip_mreq_source stReq;
+        memset(&stReq, 0, sizeof(stReq));
+        stReq.imr_multiaddr.s_addr = inet_addr(groupip);
+        stReq.imr_sourceaddr.s_addr = inet_addr(sourceip);
+        stReq.imr_interface.s_addr = (ifaceip != nullptr ? inet_addr(ifaceip) : htonl(INADDR_ANY));
+        ret = setsockopt(sk.skHandle, IPPROTO_IP, option, (char *)&stReq, sizeof(stReq));
+    }
+    if (ret < 0) {
         sk.s32Error = __ERROR__;
-        OSAL_ERR("[%s] Sending datagram message failed, %d\n", __FUNCTION__, sk.s32Error);
+        OSAL_ERR("[%s] Multicast membership %d of %s failed\n", __FUNCTION__, option, groupip);
         return RET_ERR;
     }
     return RET_OK;
 }
 
+int socket_join_multicast(SOCKET_T &sk, const char *groupip, const char *ifaceip) {
+    return socket_multicast_membership(sk, IP_ADD_MEMBERSHIP, groupip, nullptr, ifaceip);
+}
+
+int socket_leave_multicast(SOCKET_T &sk, const char *groupip, const char *ifaceip) {
+    return socket_multicast_membership(sk, IP_DROP_MEMBERSHIP, groupip, nullptr, ifaceip);
+}
+
+int socket_join_source_multicast(SOCKET_T &sk, const char *groupip, const char *sourceip, const char *ifaceip) {
+    if (sourceip == nullptr) {
+        OSAL_ERR("[%s] Invalid source\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    return socket_multicast_membership(sk, IP_ADD_SOURCE_MEMBERSHIP, groupip, sourceip, ifaceip);
+}
+
+int socket_leave_source_multicast(SOCKET_T &sk, const char *groupip, const char *sourceip, const char *ifaceip) {
+    if (sourceip == nullptr) {
+        OSAL_ERR("[%s] Invalid source\n", __FUNCTION__);
+        return RET_ERR;
+    }
+    return socket_multicast_membership(sk, IP_DROP_SOURCE_MEMBERSHIP, groupip, sourceip, ifaceip);
+}
+
+int socket_set_multicast_all(SOCKET_T &sk, int32_t enable) {
+    (void)sk;
+    (void)enable;
+    OSAL_ERR("[%s] IP_MULTICAST_ALL is not supported\n", __FUNCTION__);
+    return RET_ERR;
+}
+
+int socket_set_udp_shard_filter(SOCKET_T &sk, uint32_t offset, uint32_t count, uint32_t index) {
+    (void)sk;
+    (void)offset;
+    (void)count;
+    (void)index;
+    OSAL_ERR("[%s] Socket filters are not supported\n", __FUNCTION__);
+    return RET_ERR;
+}
+
 int socket_set_recv_buff(SOCKET_T &sk, uint32_t size) {
     int32_t s32Size = static_cast<int32_t>(size);
     socklen_t len = sizeof(int32_t);
@@ -514,4 +692,53 @@ SOCKADDR_T socket_get_name(SOCKET_T &sk) {
     }
     return addr;
 }
+
+SOCKET_PROFILE socket_get_profile_preset(int32_t profile) {
+    switch (profile) {
+    case eSOCKET_PROFILE_LOW_LATENCY:
+        return {1, -1, -1, -1, 32 * 1024, 32 * 1024};
+    case eSOCKET_PROFILE_BULK:
+        return {0, -1, -1, -1, 4 * 1024 * 1024, 4 * 1024 * 1024};
+    default:
+        return {0, -1, -1, -1, -1, -1};
+    }
+}
+
+int socket_get_profile(SOCKET_T &sk, SOCKET_PROFILE &current) {
+    (void)sk;
+    current = {-1, -1, -1, -1, -1, -1};
+    OSAL_ERR("[%s] Socket profiles are not supported\n", __FUNCTION__);
+    return RET_ERR;
+}
+
+int socket_apply_profile(SOCKET_T &sk, const SOCKET_PROFILE &profile, SOCKET_PROFILE &applied) {
+    (void)profile;
+    return socket_get_profile(sk, applied);
+}
+
+int socket_flush_cork(SOCKET_T &sk) {
+    (void)sk;
+    OSAL_ERR("[%s] TCP_CORK is not supported\n", __FUNCTION__);
+    return RET_ERR;
+}
+
+int socket_set_reuse_port(SOCKET_T &sk, int32_t enable) {
+    (void)sk;
+    (void)enable;
+    OSAL_ERR("[%s] SO_REUSEPORT is not supported\n", __FUNCTION__);
+    return RET_ERR;
+}
+
+int socket_set_reuse_port_cpu_steering(SOCKET_T &sk) {
+    (void)sk;
+    OSAL_ERR("[%s] SO_ATTACH_REUSEPORT_CBPF is not supported\n", __FUNCTION__);
+    return RET_ERR;
+}
+
+int socket_get_peer_cred(SOCKET_T &sk, SOCKET_CRED &cred) {
+    (void)sk;
+    memset(&cred, 0, sizeof(cred));
+    OSAL_ERR("[%s] Peer credentials are not supported\n", __FUNCTION__);
+    return RET_ERR;
+}
 } // namespace ipc::core
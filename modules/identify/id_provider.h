@@ -1,7 +1,13 @@
 #ifndef ID_PROVIDER_H
 #define ID_PROVIDER_H
 
-#include <mutex>
+#include <atomic>
+#include <stdint.h>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace ipc::core {
 enum class id_provider_type {
@@ -10,25 +16,59 @@ enum class id_provider_type {
     Message,
     Max,
 };
+
+/// Low bits of an origin id holding the process local id, the process id goes above
+static constexpr unsigned ID_ORIGIN_SHIFT = 40;
+
+/* Ids of a frequently created type are handed out to each thread in blocks */
+static constexpr uint64_t id_block_size(id_provider_type type) {
+    return (type == id_provider_type::Message ? 1024U : 1U);
+}
+
+/**
+ * @fn get_new_id
+ * @brief Returns an id unique within the process for the type, never 0
+ *
+ * A thread takes a block of ids from the type's atomic counter and hands them out
+ * without further synchronization, ids are unique but not ordered across threads.
+ */
 template <id_provider_type _Type>
-int get_new_id() {
-    struct id_wrap_t {
-        std::mutex mtx;
-        int id;
-    };
-    static constexpr size_t max = static_cast<size_t>(id_provider_type::Max) + 1U;
-    static id_wrap_t m_ids[max] = {
-        {{}, 0},
-        {{}, 0},
-        {{}, 0},
-        {{}, 0},
-    };
+uint64_t get_new_id() {
+    static constexpr uint64_t block = id_block_size(_Type);
+    static std::atomic<uint64_t> s_next{1};
+    if constexpr (block == 1U) {
+        return s_next.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        struct block_t {
+            uint64_t next = 0;
+            uint64_t end = 0;
+        };
+        thread_local block_t t_block;
+        if (t_block.next == t_block.end) {
+            t_block.next = s_next.fetch_add(block, std::memory_order_relaxed);
+            t_block.end = t_block.next + block;
+        }
+        return t_block.next++;
+    }
+}
 
-    id_wrap_t &wrap = m_ids[static_cast<size_t>(_Type)];
-    std::lock_guard<std::mutex> lock(wrap.mtx);
-    wrap.id += 1;
-    return wrap.id;
+/**
+ * @fn get_origin_id
+ * @brief Returns an id unique across the processes of the host for the type
+ *
+ * The process id is embedded above ID_ORIGIN_SHIFT and read on every call, so ids
+ * stay unique in a forked child.
+ */
+template <id_provider_type _Type>
+uint64_t get_origin_id() {
+#ifdef _WIN32
+    uint64_t pid = static_cast<uint64_t>(_getpid());
+#else
+    uint64_t pid = static_cast<uint64_t>(getpid());
+#endif
+    uint64_t local = get_new_id<_Type>() & ((uint64_t(1) << ID_ORIGIN_SHIFT) - 1U);
+    return (pid << ID_ORIGIN_SHIFT) | local;
 }
 } // namespace ipc::core
 
-#endif // ID_PROVIDER_H
\ No newline at end of file
+#endif // ID_PROVIDER_H
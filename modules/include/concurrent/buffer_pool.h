@@ -0,0 +1,160 @@
+/**
+ * @file buffer_pool.h
+ * @brief Defines the reference counted `buffer_ref` and the `buffer_pool` it is taken from.
+ *
+ * Receive paths fill a pooled buffer directly and hand it on, e.g. into a `message`,
+ * without copying it again. Buffers come in fixed size classes and are recycled through
+ * per-thread caches, so a steady-state receive loop does not allocate.
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+namespace ipc::core {
+
+/**
+ * @brief Header placed in front of every buffer's data.
+ */
+struct buffer_block {
+    std::atomic<uint32_t> refs; ///< Number of buffer_ref sharing the block
+    uint32_t size_class;        ///< Pool size class, buffer_pool::unpooled for oversized blocks
+    size_t size;                ///< Bytes in use
+    size_t capacity;            ///< Bytes available
+    buffer_block *next;         ///< Free list link while the block is pooled
+
+    char *data() noexcept { return reinterpret_cast<char *>(this + 1); }
+};
+
+/**
+ * @brief Reference counted handle to a pooled buffer.
+ *
+ * Copies share the same memory, the buffer goes back to the pool when the last handle
+ * is released. The buffer may be released on another thread than it was acquired on.
+ */
+class buffer_ref {
+    friend class buffer_pool;
+    buffer_block *m_block = nullptr;
+
+    explicit buffer_ref(buffer_block *block) noexcept :
+        m_block(block) {}
+
+public:
+    buffer_ref() noexcept = default;
+
+    buffer_ref(const buffer_ref &other) noexcept :
+        m_block(other.m_block) {
+        if (m_block != nullptr) {
+            m_block->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    buffer_ref(buffer_ref &&other) noexcept :
+        m_block(other.m_block) {
+        other.m_block = nullptr;
+    }
+
+    buffer_ref &operator=(const buffer_ref &other) noexcept {
+        buffer_ref(other).swap(*this);
+        return *this;
+    }
+
+    buffer_ref &operator=(buffer_ref &&other) noexcept {
+        buffer_ref(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~buffer_ref() { reset(); }
+
+    /**
+     * @brief Drops this handle, the buffer is recycled if it was the last one.
+     */
+    inline void reset() noexcept;
+
+    void swap(buffer_ref &other) noexcept {
+        buffer_block *block = m_block;
+        m_block = other.m_block;
+        other.m_block = block;
+    }
+
+    char *data() noexcept { return m_block != nullptr ? m_block->data() : nullptr; }
+    const char *data() const noexcept { return m_block != nullptr ? m_block->data() : nullptr; }
+    size_t size() const noexcept { return m_block != nullptr ? m_block->size : 0; }
+    size_t capacity() const noexcept { return m_block != nullptr ? m_block->capacity : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    /**
+     * @brief Sets the number of bytes in use, clamped to the capacity.
+     */
+    void resize(size_t size) noexcept {
+        if (m_block != nullptr) {
+            m_block->size = (size < m_block->capacity ? size : m_block->capacity);
+        }
+    }
+
+    /**
+     * @brief Returns whether this is the only handle, only then the content may be rewritten.
+     */
+    bool unique() const noexcept { return m_block != nullptr && m_block->refs.load(std::memory_order_acquire) == 1; }
+
+    explicit operator bool() const noexcept { return m_block != nullptr; }
+};
+
+/**
+ * @brief Process wide pool of buffers in fixed size classes.
+ *
+ * Every thread keeps a small cache per size class, acquire and release only touch the
+ * shared lists when that cache runs empty or full, and then move a whole batch.
+ * Requests above the largest class are served by the heap and freed on release.
+ */
+class buffer_pool {
+    friend class buffer_ref;
+    static void release(buffer_block *block) noexcept;
+
+public:
+    static constexpr size_t class_count = 5;
+    static constexpr size_t class_sizes[class_count] = {256, 1024, 4096, 16384, 65536};
+    static constexpr uint32_t unpooled = UINT32_MAX;
+
+    /**
+     * @brief Gets a buffer with at least the given capacity and a size of 0.
+     *
+     * @param capacity Requested capacity in bytes.
+     * @return A handle to the buffer, empty if the memory could not be allocated.
+     */
+    static buffer_ref acquire(size_t capacity);
+
+    /**
+     * @brief Makes buff an unshared buffer with at least the given capacity.
+     *
+     * The current buffer is kept when it qualifies, so a receive loop passing the same
+     * handle reuses one buffer until it hands it on.
+     *
+     * @param buff The handle to prepare.
+     * @param capacity Requested capacity in bytes.
+     * @return `true` if buff can be filled, `false` if the memory could not be allocated.
+     */
+    static bool reserve(buffer_ref &buff, size_t capacity);
+
+    /**
+     * @brief Frees the buffers parked on the shared lists, thread caches are kept.
+     */
+    static void trim();
+};
+
+inline void buffer_ref::reset() noexcept {
+    if (m_block != nullptr) {
+        if (m_block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            buffer_pool::release(m_block);
+        }
+        m_block = nullptr;
+    }
+}
+
+} // namespace ipc::core
+
+#endif // BUFFER_POOL_H
@@ -0,0 +1,51 @@
+/**
+ * @file endpoint.h
+ * @brief Defines `endpoint`, the process wide table of interned endpoint names.
+ *
+ * Senders, receivers and topics are named by strings at the API, but compared and
+ * looked up by the compact id the name is interned to. An id stays valid, and maps to
+ * the same name, for the lifetime of the process.
+ */
+
+#ifndef ENDPOINT_H
+#define ENDPOINT_H
+
+#include <stdint.h>
+#include <string>
+
+namespace ipc::core {
+
+/// Type alias for an interned endpoint name, 0 is the empty name
+using endpoint_id = uint32_t;
+
+/**
+ * @brief Interns endpoint names into ids and maps ids back to names.
+ *
+ * Interning takes a shared lock and, only for a name seen for the first time, the
+ * exclusive one. Mapping an id back to its name takes no lock.
+ */
+class endpoint {
+public:
+    /// The id of the empty name
+    static constexpr endpoint_id none = 0;
+
+    /**
+     * @brief Returns the id of a name, interning it on first use.
+     * @throws std::length_error when the table is full.
+     */
+    static endpoint_id intern(const std::string &name);
+
+    /**
+     * @brief Returns the id of a name already interned, `none` otherwise.
+     */
+    static endpoint_id find(const std::string &name);
+
+    /**
+     * @brief Returns the name of an id, the empty name for unknown ids.
+     */
+    static const std::string &name(endpoint_id id);
+};
+
+} // namespace ipc::core
+
+#endif // ENDPOINT_H
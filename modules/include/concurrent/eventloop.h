@@ -32,6 +32,7 @@
 namespace ipc::core {
 
 class evloop_p;
+class timer;
 
 /**
  * @class evloop
@@ -43,6 +44,9 @@ class evloop {
     evloop &operator=(const evloop &) = delete;
     evloop &operator=(evloop &&) = delete;
 
+    /* Timers are armed on the loop's worker */
+    friend class timer;
+
     std::unique_ptr<evloop_p> m_impl{nullptr};
 
 public:
@@ -102,6 +106,26 @@ public:
      */
     void set_handle(handle_w_ptr handle);
 
+    /**
+     * @brief Routes the messages of a receiver to a handler instead of run().
+     *
+     * The receiver is an exact name, a prefix followed by `*` (e.g. `sensor/` followed by
+     * `*` routes every receiver starting with `sensor/`), or `*` alone for every message. An exact route wins over the longest matching prefix.
+     * Messages without a route go to run() and to the handle set by set_handle().
+     * A route added again for the same receiver replaces the previous one.
+     *
+     * @param receiver The receiver name or pattern.
+     * @param handle A weak pointer to the message handler function.
+     */
+    void add_route(const std::string &receiver, handle_w_ptr handle);
+
+    /**
+     * @brief Removes the route of a receiver name or pattern.
+     * @param receiver The receiver name or pattern given to add_route().
+     * @return 0 if a route was removed, -1 otherwise.
+     */
+    int remove_route(const std::string &receiver);
+
     /**
      * @brief Returns the worker associated with the event loop.
      * @return A shared pointer to the worker.
@@ -114,8 +138,23 @@ public:
      */
     void post(message_ptr mesg);
 
+    /**
+     * @brief Posts a message in a priority lane of the worker.
+     *
+     * Control messages posted as worker::High are handled before queued Normal
+     * and Low messages, post(mesg) uses worker::Normal.
+     *
+     * @param mesg A shared pointer to the message to be posted.
+     * @param priority The worker lane.
+     */
+    void post(message_ptr mesg, worker::Priority priority);
+
     /**
      * @brief Template method to post a message with arguments to the event loop.
+     *
+     * The arguments are encoded straight into a pooled buffer, packed by pod_codec
+     * when they are all trivially copyable, message_args<Args...> parses both.
+     *
      * @tparam Args The types of the arguments.
      * @param sender The sender of the message.
      * @param receiver The receiver of the message.
@@ -123,10 +162,13 @@ public:
      */
     template <typename... Args>
     void post(const std::string &sender, const std::string &receiver, Args &&...args) {
-        message_args<Args...> mesg_args;
-        mesg_args.append(std::forward<Args>(args)...);
-        auto mesg = message::create(sender, receiver, mesg_args.bin());
-        post(std::move(mesg));
+        buffer_ref content{};
+        if constexpr (is_pod_args_v<std::decay_t<Args>...>) {
+            content = pod_codec<std::decay_t<Args>...>::encode_buffer(args...);
+        } else {
+            content = message_codec<std::decay_t<Args>...>::encode_buffer(args...);
+        }
+        post(message::create(sender, receiver, std::move(content)));
     }
 
     /**
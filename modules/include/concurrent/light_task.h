@@ -0,0 +1,209 @@
+/**
+ * @file light_task.h
+ * @brief Defines `light_task`, a compact task for fire-and-forget work.
+ *
+ * Unlike `task`, a light task keeps the callable and its arguments inline instead of in
+ * a `std::function`, has no callback, and is allocated together with its control block
+ * from the `task_pool`. Running it costs no lock: the mutex and condition variable are
+ * only created by the first call to `get()`.
+ */
+
+#ifndef LIGHT_TASK_H
+#define LIGHT_TASK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include "task_base.h"
+#include "task_pool.h"
+
+namespace ipc::core {
+
+namespace detail {
+
+/**
+ * @brief Keeps the return value of a light task.
+ */
+template <typename R>
+class light_value {
+public:
+    template <typename C>
+    void run(C &&call) { m_result.set(0, call()); }
+
+    /* Only called once the task finished, guarded by the caller */
+    const task_result *result() { return &m_result; }
+
+private:
+    task_result m_result = {};
+};
+
+template <>
+class light_value<void> {
+public:
+    template <typename C>
+    void run(C &&call) { call(); }
+
+    const task_result *result() { return nullptr; }
+};
+
+} // namespace detail
+
+/**
+ * @brief A task without callback whose synchronization is created on demand.
+ *
+ * @tparam R The return type of the function.
+ * @tparam F The type of the function object, stored inline.
+ * @tparam Args The decayed types of the arguments, stored inline.
+ */
+template <class R, class F, class... Args>
+class light_task : public task_base {
+    light_task(const light_task &) = delete;
+    light_task(light_task &&) = delete;
+    light_task &operator=(const light_task &) = delete;
+    light_task &operator=(light_task &&) = delete;
+
+    /* Created by the first get() that has to wait, lives as long as the task */
+    struct waiter {
+        std::mutex mtx;
+        std::condition_variable condition;
+    };
+
+public:
+    /**
+     * @brief Constructs a task with the given function and arguments.
+     *
+     * @param func The function to execute.
+     * @param args The arguments to pass to the function, stored by value.
+     */
+    template <typename G, typename... A>
+    explicit light_task(G &&func, A &&...args) :
+        m_func(std::forward<G>(func)),
+        m_args(std::forward<A>(args)...),
+        m_task_state(static_cast<int>(task_base::state::Created)),
+        m_waiter(nullptr),
+        m_exception_ptr{nullptr},
+        m_value{} {}
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~light_task() {
+        delete m_waiter.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Executes the task, waking waiters only if someone waits.
+     */
+    void execute() override {
+        m_task_state.store(static_cast<int>(task_base::state::Executing), std::memory_order_relaxed);
+        try {
+            m_value.run([this] { return std::apply(m_func, m_args); });
+            m_task_state.store(static_cast<int>(task_base::state::Finished));
+        } catch (...) {
+            m_exception_ptr = std::current_exception();
+            m_task_state.store(static_cast<int>(task_base::state::Failed));
+        }
+
+        /* Either get() sees the final state or we see its waiter, both are seq_cst */
+        waiter *w = m_waiter.load();
+        if (w != nullptr) {
+            {
+                std::lock_guard<std::mutex> lock(w->mtx);
+            }
+            w->condition.notify_all();
+        }
+    }
+
+    /**
+     * @brief Returns the exception pointer if an exception was thrown during execution.
+     */
+    std::exception_ptr exception_ptr() const override {
+        return (done() ? m_exception_ptr : nullptr);
+    }
+
+    /**
+     * @brief Blocks until the task is done or the timeout expires.
+     *
+     * @param ms The timeout in milliseconds.
+     * @return The result of the task, `nullptr` for tasks with `void` return type or on timeout.
+     */
+    const task_result *get(int ms = si_task_get_timeout) override {
+        if (!done()) {
+            waiter *w = m_waiter.load();
+            if (w == nullptr) {
+                waiter *fresh = new waiter();
+                if (m_waiter.compare_exchange_strong(w, fresh)) {
+                    w = fresh;
+                } else {
+                    delete fresh;
+                }
+            }
+            std::unique_lock<std::mutex> lock(w->mtx);
+            if (!w->condition.wait_for(lock, std::chrono::milliseconds(ms), [this] { return done(); })) {
+                return nullptr;
+            }
+        }
+        return m_value.result();
+    }
+
+    /**
+     * @brief Returns the current state of the task.
+     */
+    int state() const override {
+        return m_task_state.load();
+    }
+
+    /**
+     * @brief Checks if the task has finished execution.
+     */
+    bool finished() const override {
+        return (m_task_state.load() == static_cast<int>(task_base::state::Finished));
+    }
+
+    /**
+     * @brief Checks if the task encountered an error during execution.
+     */
+    bool error() const override {
+        return (m_task_state.load() == static_cast<int>(task_base::state::Failed));
+    }
+
+private:
+    bool done() const {
+        int state = m_task_state.load();
+        return (state == static_cast<int>(task_base::state::Finished) || state == static_cast<int>(task_base::state::Failed));
+    }
+
+    F m_func;                           ///< The function to execute.
+    std::tuple<Args...> m_args;         ///< The arguments for the function.
+    std::atomic<int> m_task_state;      ///< The state of the task.
+    std::atomic<waiter *> m_waiter;     ///< Created by the first waiting get().
+    std::exception_ptr m_exception_ptr; ///< The exception pointer if an exception occurred.
+    detail::light_value<R> m_value;     ///< The result of the task.
+};
+
+/**
+ * @brief Creates a light task from the task pool.
+ *
+ * The function and the arguments are copied or moved into the task.
+ *
+ * @param func The function to execute.
+ * @param args The arguments to pass to the function.
+ * @return A `std::shared_ptr` to the created task.
+ */
+template <typename F, typename... Args>
+auto make_light_task(F &&func, Args &&...args) {
+    using FuncType = std::decay_t<F>;
+    using ResultType = std::invoke_result_t<FuncType &, std::decay_t<Args> &...>;
+    using TaskType = light_task<ResultType, FuncType, std::decay_t<Args>...>;
+    return std::allocate_shared<TaskType>(task_allocator<TaskType>(), std::forward<F>(func), std::forward<Args>(args)...);
+}
+
+} // namespace ipc::core
+
+#endif // LIGHT_TASK_H
@@ -11,6 +11,11 @@
 #include <string>
 #include <memory>
 #include <optional>
+#include <array>
+#include <tuple>
+#include "buffer_pool.h"
+#include "endpoint.h"
+#include "mesg_codec.h"
 
 namespace ipc::core {
 
@@ -55,16 +60,30 @@ public:
     /**
      * @brief Retrieves the sender of the message.
      *
-     * @return A string representing the sender's name.
+     * @return The sender's name, interned for the lifetime of the process.
      */
-    virtual std::string sender() const = 0;
+    virtual const std::string &sender() const = 0;
 
     /**
      * @brief Retrieves the receiver of the message.
      *
-     * @return A string representing the receiver's name.
+     * @return The receiver's name, interned for the lifetime of the process.
      */
-    virtual std::string receiver() const = 0;
+    virtual const std::string &receiver() const = 0;
+
+    /**
+     * @brief Retrieves the interned id of the sender.
+     *
+     * @return The id `endpoint::intern(sender())` returns.
+     */
+    virtual endpoint_id sender_id() const = 0;
+
+    /**
+     * @brief Retrieves the interned id of the receiver.
+     *
+     * @return The id `endpoint::intern(receiver())` returns.
+     */
+    virtual endpoint_id receiver_id() const = 0;
 
     /**
      * @brief Retrieves the content of the message.
@@ -89,17 +108,143 @@ public:
      * @return A shared pointer to the newly created message.
      */
     static message_ptr create(const std::string &sender, const std::string &receiver, const std::string &content);
+
+    /**
+     * @brief Factory method to create a new message that takes over its content.
+     *
+     * @param sender The sender of the message.
+     * @param receiver The receiver of the message.
+     * @param content The content of the message, moved into the message.
+     * @return A shared pointer to the newly created message.
+     */
+    static message_ptr create(const std::string &sender, const std::string &receiver, std::string &&content);
+
+    /**
+     * @brief Factory method to create a new message that adopts a pooled buffer.
+     *
+     * The buffer is shared, not copied, the message content is its first `size()` bytes.
+     *
+     * @param sender The sender of the message.
+     * @param receiver The receiver of the message.
+     * @param content The buffer holding the message content.
+     * @return A shared pointer to the newly created message.
+     */
+    static message_ptr create(const std::string &sender, const std::string &receiver, buffer_ref content);
+
+    /**
+     * @brief Factory methods taking endpoints interned beforehand with `endpoint::intern()`.
+     *
+     * Hot paths intern their endpoints once and skip the name lookup on every message.
+     */
+    static message_ptr create(endpoint_id sender, endpoint_id receiver, const std::string &content);
+    static message_ptr create(endpoint_id sender, endpoint_id receiver, std::string &&content);
+    static message_ptr create(endpoint_id sender, endpoint_id receiver, buffer_ref content);
 };
 
 /**
- * @brief A template class for parsing messages of a specific type.
+ * @brief Zero-copy typed view over the content of a message.
  *
- * This class can be specialized for different message types to provide custom parsing logic.
+ * The constructor walks the `arg_element` headers once, or recognizes a `pod_codec`
+ * image, and records where every field starts. get<I>() then reads field I in place:
+ * trivially copyable fields are returned by value, strings as `std::string_view` and
+ * `std::vector<T>` fields as `array_view<T>`, all pointing into the message, which the
+ * parser keeps alive.
  *
- * @tparam T The type of message to parse.
+ * @tparam Args The field types, as given to message_args or message_codec.
  */
-template <class T>
+template <class... Args>
 class message_parser {
+    static constexpr size_t count = sizeof...(Args);
+
+    template <size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Args...>>;
+
+public:
+    /**
+     * @brief Parses the content of a message.
+     * @param mesg The message, kept alive by the parser.
+     */
+    explicit message_parser(message_ptr mesg) :
+        m_mesg(std::move(mesg)) {
+        if (m_mesg != nullptr) {
+            parse(m_mesg->data(), m_mesg->size());
+        }
+    }
+
+    /**
+     * @brief Parses a buffer, which must outlive the parser.
+     */
+    message_parser(const char *data, size_t size) {
+        parse(data, size);
+    }
+
+    /**
+     * @brief Returns whether the content holds exactly Args in order.
+     */
+    bool valid() const { return m_valid; }
+
+    /**
+     * @brief Returns the view of field I, the content must be valid().
+     */
+    template <size_t I>
+    typename arg_view<field_type<I>>::type get() const {
+        return arg_view<field_type<I>>::read(m_data + m_offsets[I], m_sizes[I]);
+    }
+
+    /**
+     * @brief Returns the encoded size of field I.
+     */
+    size_t size(size_t index) const { return (index < count ? m_sizes[index] : 0); }
+
+private:
+    void parse(const char *data, size_t size) {
+        m_data = data;
+        if (data == nullptr) {
+            return;
+        }
+        if constexpr (is_pod_args_v<Args...>) {
+            if (pod_codec<Args...>::matches(data, size)) {
+                set_pod_offsets(std::index_sequence_for<Args...>{});
+                m_valid = true;
+                return;
+            }
+        }
+
+        const char *pos = data;
+        const char *end = data + size;
+        for (size_t i = 0; i < count; i++) {
+            arg_element ele = {0, 0};
+            if (static_cast<size_t>(end - pos) < sizeof(ele)) {
+                return;
+            }
+            memcpy(&ele, pos, sizeof(ele));
+            pos += sizeof(ele);
+            if (ele.id != static_cast<int32_t>(i) || ele.size < 0 || static_cast<size_t>(end - pos) < static_cast<size_t>(ele.size)) {
+                return;
+            }
+            m_offsets[i] = static_cast<size_t>(pos - data);
+            m_sizes[i] = static_cast<size_t>(ele.size);
+            pos += ele.size;
+        }
+        /* Bytes left over mean more fields, a prefix of the types is another schema */
+        m_valid = (pos == end && check_sizes(std::index_sequence_for<Args...>{}));
+    }
+
+    template <size_t... I>
+    bool check_sizes(std::index_sequence<I...>) const {
+        return (arg_view<field_type<I>>::check(m_sizes[I]) && ...);
+    }
+
+    template <size_t... I>
+    void set_pod_offsets(std::index_sequence<I...>) {
+        ((m_offsets[I] = pod_codec<Args...>::template offset<I>(), m_sizes[I] = sizeof(field_type<I>)), ...);
+    }
+
+    message_ptr m_mesg = nullptr;
+    const char *m_data = nullptr;
+    std::array<size_t, count> m_offsets = {};
+    std::array<size_t, count> m_sizes = {};
+    bool m_valid = false;
 };
 
 /**
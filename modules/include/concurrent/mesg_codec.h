@@ -0,0 +1,534 @@
+/**
+ * @file mesg_codec.h
+ * @brief Defines `message_codec`, the contiguous encoder and decoder of message arguments.
+ *
+ * Every argument is written as an `arg_element {index, size}` header followed by its
+ * bytes, the format `message_args` has always produced. The encoded size is computed
+ * from the arguments first, so encoding is a single pass into one buffer, and decoding
+ * walks a `const char *` view without copying it.
+ *
+ * Argument lists made only of trivially copyable types can instead be packed by
+ * `pod_codec` into a fixed struct image tagged with a magic and a schema hash, which
+ * `message_codec` recognizes when decoding.
+ */
+
+#ifndef MESG_CODEC_H
+#define MESG_CODEC_H
+
+#include <stdint.h>
+#include <new>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "buffer_pool.h"
+
+namespace ipc::core {
+
+/**
+ * @brief Header written in front of every encoded argument.
+ */
+struct arg_element {
+    int32_t id;   ///< Index of the argument
+    int32_t size; ///< Size of the bytes following the header
+};
+
+/**
+ * @brief Encodes and decodes one argument type, trivially copyable types are raw bytes.
+ */
+template <typename T, typename = void>
+struct arg_codec {
+    static_assert(std::is_trivially_copyable_v<T>, "message arguments must be trivially copyable or strings");
+
+    static constexpr size_t fixed_size = sizeof(T);
+
+    static size_t size(const T &) { return sizeof(T); }
+
+    static void write(char *dst, const T &value) { memcpy(dst, &value, sizeof(T)); }
+
+    static bool read(const char *src, size_t size, T &value) {
+        if (size != sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, src, sizeof(T));
+        return true;
+    }
+};
+
+template <>
+struct arg_codec<std::string> {
+    static constexpr size_t fixed_size = 0;
+
+    static size_t size(const std::string &value) { return value.size(); }
+
+    static void write(char *dst, const std::string &value) { memcpy(dst, value.data(), value.size()); }
+
+    static bool read(const char *src, size_t size, std::string &value) {
+        value.assign(src, size);
+        return true;
+    }
+};
+
+/* Decodes as a view into the encoded buffer, valid as long as the buffer is */
+template <>
+struct arg_codec<std::string_view> {
+    static constexpr size_t fixed_size = 0;
+
+    static size_t size(std::string_view value) { return value.size(); }
+
+    static void write(char *dst, std::string_view value) { memcpy(dst, value.data(), value.size()); }
+
+    static bool read(const char *src, size_t size, std::string_view &value) {
+        value = std::string_view(src, size);
+        return true;
+    }
+};
+
+/*
+ * Encodes the characters without the terminator. Encode only: the bytes in the buffer are
+ * not terminated and a decoded pointer would have no owner, decode the field as
+ * std::string or std::string_view instead.
+ */
+template <>
+struct arg_codec<const char *> {
+    static constexpr size_t fixed_size = 0;
+
+    static size_t size(const char *value) { return (value != nullptr ? strlen(value) : 0); }
+
+    static void write(char *dst, const char *value) { memcpy(dst, value, size(value)); }
+
+    static bool read(const char *src, size_t size, const char *&value) = delete;
+};
+
+/* Arrays of trivially copyable elements are their raw bytes */
+template <typename T>
+struct arg_codec<std::vector<T>> {
+    static_assert(std::is_trivially_copyable_v<T>, "array elements must be trivially copyable");
+
+    static constexpr size_t fixed_size = 0;
+
+    static size_t size(const std::vector<T> &value) { return value.size() * sizeof(T); }
+
+    static void write(char *dst, const std::vector<T> &value) {
+        if (!value.empty()) {
+            memcpy(dst, value.data(), value.size() * sizeof(T));
+        }
+    }
+
+    static bool read(const char *src, size_t size, std::vector<T> &value) {
+        if (size % sizeof(T) != 0) {
+            return false;
+        }
+        value.resize(size / sizeof(T));
+        if (size > 0) {
+            memcpy(value.data(), src, size);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Read-only view of an encoded array, elements are copied out on access.
+ *
+ * Encoded fields have no alignment guarantee, so the view hands out values rather
+ * than references into the buffer.
+ */
+template <typename T>
+class array_view {
+public:
+    array_view() = default;
+    array_view(const char *data, size_t count) :
+        m_data(data),
+        m_count(count) {}
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    T operator[](size_t index) const {
+        T value;
+        memcpy(&value, m_data + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    /// The encoded bytes of the elements
+    const char *bytes() const { return m_data; }
+
+private:
+    const char *m_data = nullptr;
+    size_t m_count = 0;
+};
+
+/**
+ * @brief How a field of type T is read in place, without copying the buffer.
+ */
+template <typename T, typename = void>
+struct arg_view {
+    using type = T;
+
+    static bool check(size_t size) { return size == sizeof(T); }
+
+    static type read(const char *src, size_t) {
+        T value;
+        memcpy(&value, src, sizeof(T));
+        return value;
+    }
+};
+
+template <typename T>
+struct arg_view<T, std::enable_if_t<std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> || std::is_same_v<T, const char *>>> {
+    using type = std::string_view;
+
+    static bool check(size_t) { return true; }
+
+    static type read(const char *src, size_t size) { return std::string_view(src, size); }
+};
+
+template <typename T>
+struct arg_view<std::vector<T>> {
+    using type = array_view<T>;
+
+    static bool check(size_t size) { return size % sizeof(T) == 0; }
+
+    static type read(const char *src, size_t size) { return array_view<T>(src, size / sizeof(T)); }
+};
+
+/**
+ * @brief Header of a packed struct image, never a valid first `arg_element`.
+ */
+struct pod_header {
+    uint32_t magic;  ///< pod_magic
+    uint32_t schema; ///< pod_codec<Args...>::schema of the writer
+};
+
+/// "POD1", the first element of the element format has id 0 and cannot match it
+static constexpr uint32_t pod_magic = 0x31444F50U;
+
+/**
+ * @brief Whether an argument list can be packed by pod_codec.
+ *
+ * Character pointers are excluded, the element format encodes them as strings.
+ */
+template <typename... Args>
+inline constexpr bool is_pod_args_v = (sizeof...(Args) > 0)
+                                      && ((std::is_trivially_copyable_v<Args> && !std::is_same_v<Args, const char *> && !std::is_same_v<Args, char *>) && ...);
+
+namespace detail {
+
+/* Nested members give every field a fixed, naturally aligned offset */
+template <typename T, typename... Ts>
+struct pod_fields {
+    T first;
+    pod_fields<Ts...> rest;
+};
+
+/* The last field ends the chain, an empty tail member would still take space */
+template <typename T>
+struct pod_fields<T> {
+    T first;
+};
+
+template <size_t I, typename T, typename... Ts>
+constexpr const auto &pod_get(const pod_fields<T, Ts...> &fields) {
+    if constexpr (I == 0) {
+        return fields.first;
+    } else {
+        return pod_get<I - 1>(fields.rest);
+    }
+}
+
+template <size_t I, typename T, typename... Ts>
+constexpr auto &pod_get(pod_fields<T, Ts...> &fields) {
+    if constexpr (I == 0) {
+        return fields.first;
+    } else {
+        return pod_get<I - 1>(fields.rest);
+    }
+}
+
+template <typename T>
+constexpr uint32_t pod_kind() {
+    if constexpr (std::is_floating_point_v<T>) {
+        return 1;
+    } else if constexpr (std::is_integral_v<T>) {
+        return (std::is_signed_v<T> ? 2 : 3);
+    } else if constexpr (std::is_pointer_v<T>) {
+        return 4;
+    } else if constexpr (std::is_enum_v<T>) {
+        return 5;
+    } else {
+        return 6;
+    }
+}
+
+/* FNV-1a over one word */
+constexpr uint32_t pod_hash(uint32_t hash, uint32_t word) {
+    for (int i = 0; i < 4; i++) {
+        hash = (hash ^ ((word >> (i * 8)) & 0xFFU)) * 16777619U;
+    }
+    return hash;
+}
+
+} // namespace detail
+
+/**
+ * @brief Packs trivially copyable arguments into a fixed struct image.
+ *
+ * Encoding builds the image and copies it with one memcpy, decoding checks the size,
+ * the magic and the schema hash, then copies the image back with one memcpy. The
+ * schema hash covers the count, order, size, alignment and kind of the fields, so a
+ * reader built with a different argument list rejects the message.
+ *
+ * @tparam Args The argument types, see is_pod_args_v.
+ */
+template <typename... Args>
+class pod_codec {
+    static_assert(is_pod_args_v<Args...>, "pod_codec needs trivially copyable arguments");
+
+    template <size_t... I>
+    static void set_fields(detail::pod_fields<Args...> &fields, std::index_sequence<I...>, const Args &...args) {
+        (memcpy(&detail::pod_get<I>(fields), &args, sizeof(Args)), ...);
+    }
+
+    template <size_t... I>
+    static std::tuple<Args...> to_tuple(const detail::pod_fields<Args...> &fields, std::index_sequence<I...>) {
+        return std::tuple<Args...>(detail::pod_get<I>(fields)...);
+    }
+
+public:
+    /**
+     * @brief The packed layout, header first.
+     */
+    struct image {
+        pod_header header;
+        detail::pod_fields<Args...> fields;
+    };
+
+    /// Encoded size of every message of this argument list
+    static constexpr size_t size = sizeof(image);
+
+    /// Hash of the layout, written after the magic
+    static constexpr uint32_t schema = [] {
+        uint32_t hash = detail::pod_hash(2166136261U, static_cast<uint32_t>(sizeof...(Args)));
+        ((hash = detail::pod_hash(hash, static_cast<uint32_t>(sizeof(Args) | (alignof(Args) << 16) | (detail::pod_kind<Args>() << 24)))), ...);
+        return detail::pod_hash(hash, static_cast<uint32_t>(sizeof(image)));
+    }();
+
+    /**
+     * @brief Returns whether buf holds an image of this argument list.
+     */
+    static bool matches(const char *buf, size_t len) {
+        pod_header header = {0, 0};
+        if (buf == nullptr || len != size) {
+            return false;
+        }
+        memcpy(&header, buf, sizeof(header));
+        return (header.magic == pod_magic && header.schema == schema);
+    }
+
+    /**
+     * @brief Packs the arguments into buf.
+     * @return size, or 0 when len is too small.
+     */
+    static size_t encode(char *buf, size_t len, const Args &...args) {
+        if (buf == nullptr || len < size) {
+            return 0;
+        }
+        /* The padding between the fields goes on the wire too, it must not carry stack contents */
+        image img;
+        memset(&img, 0, sizeof(img));
+        img.header.magic = pod_magic;
+        img.header.schema = schema;
+        set_fields(img.fields, std::index_sequence_for<Args...>{}, args...);
+        memcpy(buf, &img, size);
+        return size;
+    }
+
+    /**
+     * @brief Packs the arguments into a string.
+     */
+    static std::string encode(const Args &...args) {
+        std::string out(size, '\0');
+        encode(out.data(), out.size(), args...);
+        return out;
+    }
+
+    /**
+     * @brief Packs the arguments into a buffer from the buffer pool.
+     * @throws std::bad_alloc when no buffer could be allocated.
+     */
+    static buffer_ref encode_buffer(const Args &...args) {
+        buffer_ref buff = buffer_pool::acquire(size);
+        if (!buff) {
+            throw std::bad_alloc();
+        }
+        encode(buff.data(), buff.capacity(), args...);
+        buff.resize(size);
+        return buff;
+    }
+
+    /**
+     * @brief Copies the image out of buf, fields are then read with get<I>(img).
+     * @return False when buf does not hold an image of this argument list.
+     */
+    static bool decode(const char *buf, size_t len, image &img) {
+        if (!matches(buf, len)) {
+            return false;
+        }
+        memcpy(&img, buf, size);
+        return true;
+    }
+
+    /**
+     * @brief Unpacks the arguments from buf.
+     * @return False when buf does not hold an image of this argument list.
+     */
+    static bool decode(const char *buf, size_t len, std::tuple<Args...> &values) {
+        image img;
+        if (!decode(buf, len, img)) {
+            return false;
+        }
+        values = to_tuple(img.fields, std::index_sequence_for<Args...>{});
+        return true;
+    }
+
+    /**
+     * @brief Returns the offset of field I in the image.
+     */
+    template <size_t I>
+    static size_t offset() {
+        static const image s_img{};
+        return static_cast<size_t>(reinterpret_cast<const char *>(&detail::pod_get<I>(s_img.fields)) - reinterpret_cast<const char *>(&s_img));
+    }
+
+    /**
+     * @brief Returns field I of a decoded image.
+     */
+    template <size_t I>
+    static const auto &get(const image &img) {
+        return detail::pod_get<I>(img.fields);
+    }
+};
+
+/**
+ * @brief Encodes an argument list into, and decodes it from, one contiguous buffer.
+ *
+ * @tparam Args The argument types, trivially copyable or strings.
+ */
+template <typename... Args>
+class message_codec {
+    using tuple_type = std::tuple<Args...>;
+
+public:
+    /// Encoded size of the argument list when every string is empty
+    static constexpr size_t fixed_size = ((sizeof(arg_element) + arg_codec<Args>::fixed_size) + ... + 0);
+
+    /**
+     * @brief Returns the number of bytes encode() writes for the arguments.
+     */
+    static size_t encoded_size(const Args &...args) {
+        return ((sizeof(arg_element) + arg_codec<Args>::size(args)) + ... + 0);
+    }
+
+    /**
+     * @brief Encodes the arguments into buf.
+     * @return The number of bytes written, 0 when size is too small.
+     */
+    static size_t encode(char *buf, size_t size, const Args &...args) {
+        size_t need = encoded_size(args...);
+        if (buf == nullptr || need > size) {
+            return 0;
+        }
+        char *pos = buf;
+        int32_t id = 0;
+        (write_field(pos, id++, args), ...);
+        return need;
+    }
+
+    /**
+     * @brief Encodes the arguments into a string sized once.
+     */
+    static std::string encode(const Args &...args) {
+        std::string out(encoded_size(args...), '\0');
+        encode(out.data(), out.size(), args...);
+        return out;
+    }
+
+    /**
+     * @brief Encodes the arguments into a buffer from the buffer pool.
+     * @throws std::bad_alloc when no buffer could be allocated.
+     */
+    static buffer_ref encode_buffer(const Args &...args) {
+        size_t need = encoded_size(args...);
+        buffer_ref buff = buffer_pool::acquire(need);
+        if (!buff) {
+            throw std::bad_alloc();
+        }
+        encode(buff.data(), buff.capacity(), args...);
+        buff.resize(need);
+        return buff;
+    }
+
+    /**
+     * @brief Decodes the arguments from buf, in the element format or packed by pod_codec.
+     * @return False when the buffer is truncated, has bytes left over, or does not hold
+     *         exactly these types in order.
+     */
+    static bool decode(const char *buf, size_t size, tuple_type &values) {
+        if (buf == nullptr) {
+            return false;
+        }
+        if constexpr (is_pod_args_v<Args...>) {
+            uint32_t magic = 0;
+            if (size >= sizeof(magic)) {
+                memcpy(&magic, buf, sizeof(magic));
+                if (magic == pod_magic) {
+                    return pod_codec<Args...>::decode(buf, size, values);
+                }
+            }
+        }
+        const char *pos = buf;
+        const char *end = buf + size;
+        /* Bytes left over mean more fields, a prefix of the types is another schema */
+        return (decode(pos, end, values, std::index_sequence_for<Args...>{}) && pos == end);
+    }
+
+private:
+    template <typename T>
+    static void write_field(char *&pos, int32_t id, const T &value) {
+        arg_element ele = {id, static_cast<int32_t>(arg_codec<T>::size(value))};
+        memcpy(pos, &ele, sizeof(ele));
+        pos += sizeof(ele);
+        arg_codec<T>::write(pos, value);
+        pos += ele.size;
+    }
+
+    template <size_t... I>
+    static bool decode(const char *&pos, const char *end, tuple_type &values, std::index_sequence<I...>) {
+        return (read_field(pos, end, static_cast<int32_t>(I), std::get<I>(values)) && ...);
+    }
+
+    template <typename T>
+    static bool read_field(const char *&pos, const char *end, int32_t id, T &value) {
+        arg_element ele = {0, 0};
+        if (static_cast<size_t>(end - pos) < sizeof(ele)) {
+            return false;
+        }
+        memcpy(&ele, pos, sizeof(ele));
+        pos += sizeof(ele);
+        if (ele.id != id || ele.size < 0 || static_cast<size_t>(end - pos) < static_cast<size_t>(ele.size)) {
+            return false;
+        }
+        if (!arg_codec<T>::read(pos, static_cast<size_t>(ele.size), value)) {
+            return false;
+        }
+        pos += ele.size;
+        return true;
+    }
+};
+
+} // namespace ipc::core
+
+#endif // MESG_CODEC_H
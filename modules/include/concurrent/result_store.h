@@ -0,0 +1,303 @@
+/**
+ * @file result_store.h
+ * @brief Defines `result_store`, the small keyed value store holding task results.
+ *
+ * A task stores one value at key 0, so the store keeps its first value inline and only
+ * allocates for further keys. Values are tagged with a per-type address instead of RTTI,
+ * and values up to `inline_size` bytes live in the slot itself.
+ */
+
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "except.h"
+
+namespace ipc::core {
+
+namespace detail {
+/* One object per type, its address is the type tag */
+template <typename T>
+struct result_tag {
+    static constexpr char id = 0;
+};
+} // namespace detail
+
+/**
+ * @brief Keyed store of values of any type, with the interface of meta_container_i.
+ *
+ * Getting a value with another type than it was set with throws, or returns
+ * std::nullopt for the optional getter, as meta_container does.
+ */
+class result_store {
+    static constexpr size_t inline_size = 32;
+
+    /* Type erased operations of a slot value */
+    struct ops_t {
+        void (*destroy)(void *storage) noexcept;
+        void (*move)(void *dst, void *src) noexcept; ///< Move constructs dst and destroys src
+    };
+
+    template <typename T>
+    static constexpr bool fits_v = (sizeof(T) <= inline_size && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>);
+
+    template <typename T>
+    static const ops_t *ops_of() {
+        static const ops_t s_ops = {
+            [](void *storage) noexcept {
+                if constexpr (fits_v<T>) {
+                    static_cast<T *>(storage)->~T();
+                } else {
+                    delete *static_cast<T **>(storage);
+                }
+            },
+            [](void *dst, void *src) noexcept {
+                if constexpr (fits_v<T>) {
+                    new (dst) T(std::move(*static_cast<T *>(src)));
+                    static_cast<T *>(src)->~T();
+                } else {
+                    *static_cast<T **>(dst) = *static_cast<T **>(src);
+                }
+            },
+        };
+        return &s_ops;
+    }
+
+    class slot {
+    public:
+        slot() = default;
+
+        slot(slot &&other) noexcept :
+            key(other.key),
+            tag(other.tag),
+            ops(other.ops) {
+            if (ops != nullptr) {
+                ops->move(storage, other.storage);
+                other.tag = nullptr;
+                other.ops = nullptr;
+            }
+        }
+
+        slot &operator=(slot &&other) noexcept {
+            if (this != &other) {
+                reset();
+                new (this) slot(std::move(other));
+            }
+            return *this;
+        }
+
+        ~slot() { reset(); }
+
+        template <typename T, typename V>
+        void emplace(int k, V &&value) {
+            if constexpr (fits_v<T>) {
+                new (storage) T(std::forward<V>(value));
+            } else {
+                *reinterpret_cast<T **>(storage) = new T(std::forward<V>(value));
+            }
+            key = k;
+            tag = &detail::result_tag<T>::id;
+            ops = ops_of<T>();
+        }
+
+        void reset() noexcept {
+            if (ops != nullptr) {
+                ops->destroy(storage);
+                tag = nullptr;
+                ops = nullptr;
+            }
+        }
+
+        bool used() const { return tag != nullptr; }
+
+        template <typename T>
+        T *value() {
+            if (tag != &detail::result_tag<T>::id) {
+                return nullptr;
+            }
+            if constexpr (fits_v<T>) {
+                return std::launder(reinterpret_cast<T *>(storage));
+            } else {
+                return *reinterpret_cast<T **>(storage);
+            }
+        }
+
+        template <typename T>
+        const T *value() const { return const_cast<slot *>(this)->value<T>(); }
+
+        int key = 0;
+        const void *tag = nullptr;
+        const ops_t *ops = nullptr;
+        alignas(std::max_align_t) unsigned char storage[inline_size];
+    };
+
+public:
+    /**
+     * @brief Proxy class for assigning and retrieving values from the store using a key.
+     */
+    class value_proxy {
+    public:
+        value_proxy(result_store &store, int key) :
+            _store(store), _key(key) {}
+
+        template <typename T>
+        value_proxy &operator=(T &&value) {
+            _store.set(_key, std::forward<T>(value));
+            return *this;
+        }
+
+        explicit operator int() { return _store.get<int>(_key); }
+
+        explicit operator unsigned int() { return _store.get<unsigned int>(_key); }
+
+        explicit operator int64_t() { return _store.get<int64_t>(_key); }
+
+        explicit operator uint64_t() { return _store.get<uint64_t>(_key); }
+
+        explicit operator double() { return _store.get<double>(_key); }
+
+        explicit operator float() { return _store.get<float>(_key); }
+
+        explicit operator const std::string &() const { return _store.data<std::string>(_key); }
+
+        explicit operator const char *() const { return _store.data<std::string>(_key).c_str(); }
+
+    private:
+        result_store &_store; ///< Reference to the store.
+        int _key;             ///< The key associated with the value.
+    };
+
+    result_store() = default;
+    result_store(result_store &&) noexcept = default;
+    result_store &operator=(result_store &&) noexcept = default;
+    result_store(const result_store &) = delete;
+    result_store &operator=(const result_store &) = delete;
+
+    /**
+     * @brief Returns a proxy for accessing and modifying the value of a key.
+     */
+    value_proxy operator[](int key) {
+        return value_proxy(*this, key);
+    }
+
+    /**
+     * @brief Sets the value of a key, throws if the key holds another type.
+     */
+    template <typename T>
+    result_store &set(int key, const T &value) {
+        return assign<T>(key, value);
+    }
+
+    template <typename T>
+    result_store &set(int key, T &&value) {
+        return assign<std::decay_t<T>>(key, std::forward<T>(value));
+    }
+
+    /**
+     * @brief Returns the value of a key, throws if not found or of another type.
+     */
+    template <typename T>
+    T &get(int key) {
+        slot *s = find(key);
+        if (s == nullptr) {
+            ipc_throw_exception("Key not found");
+        }
+        T *value = s->value<T>();
+        if (value == nullptr) {
+            ipc_throw_exception("Type mismatch for the key");
+        }
+        return *value;
+    }
+
+    /**
+     * @brief Returns a copy of the value of a key, std::nullopt if not found or of another type.
+     */
+    template <typename T>
+    std::optional<T> get(int key) const {
+        const slot *s = find(key);
+        const T *value = (s != nullptr ? s->value<T>() : nullptr);
+        if (value == nullptr) {
+            return std::nullopt;
+        }
+        return std::optional<T>(std::in_place, *value);
+    }
+
+    /**
+     * @brief Returns the value of a key, throws if not found or of another type.
+     */
+    template <typename T>
+    const T &data(int key) const {
+        return const_cast<result_store *>(this)->get<T>(key);
+    }
+
+    /**
+     * @brief Removes the value of a key, if any.
+     */
+    void erase(int key) noexcept {
+        if (m_first.used() && m_first.key == key) {
+            m_first.reset();
+            return;
+        }
+        for (auto it = m_more.begin(); it != m_more.end(); ++it) {
+            if (it->key == key) {
+                m_more.erase(it);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the number of keys holding a value.
+     */
+    size_t size() const {
+        return (m_first.used() ? 1U : 0U) + m_more.size();
+    }
+
+private:
+    template <typename T, typename V>
+    result_store &assign(int key, V &&value) {
+        slot *s = find(key);
+        if (s != nullptr) {
+            T *current = s->value<T>();
+            if (current == nullptr) {
+                ipc_throw_exception("Type mismatch for the key");
+            }
+            *current = std::forward<V>(value);
+        } else if (!m_first.used()) {
+            m_first.emplace<T>(key, std::forward<V>(value));
+        } else {
+            slot more;
+            more.emplace<T>(key, std::forward<V>(value));
+            m_more.push_back(std::move(more));
+        }
+        return *this;
+    }
+
+    slot *find(int key) {
+        if (m_first.used() && m_first.key == key) {
+            return &m_first;
+        }
+        for (auto &s : m_more) {
+            if (s.key == key) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    const slot *find(int key) const { return const_cast<result_store *>(this)->find(key); }
+
+    slot m_first{};             ///< The first value, key 0 of a task.
+    std::vector<slot> m_more{}; ///< Further keys, allocated on demand.
+};
+
+} // namespace ipc::core
+
+#endif // RESULT_STORE_H
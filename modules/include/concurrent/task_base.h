@@ -12,7 +12,7 @@
 #define TASK_BASE_H
 
 #include <memory>
-#include "meta.h"
+#include "result_store.h"
 
 namespace ipc::core {
 
@@ -20,9 +20,10 @@ namespace ipc::core {
  * @typedef task_result
  * @brief Alias for the result type used in tasks.
  *
- * The result of a task is encapsulated in a `meta_container_i` instance.
+ * The result of a task is encapsulated in a `result_store`, which holds the
+ * return value at key 0 without allocating.
  */
-using task_result = meta_container_i;
+using task_result = result_store;
 
 /**
  * @brief Default timeout for getting task results in milliseconds.
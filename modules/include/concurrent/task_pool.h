@@ -0,0 +1,76 @@
+/**
+ * @file task_pool.h
+ * @brief Defines the `task_pool` small object pool and the `task_allocator` using it.
+ *
+ * Tasks are allocated on the posting thread and freed on the worker thread once they
+ * ran. Blocks are recycled through per-thread caches, so a worker spawning tasks, or
+ * a producer posting to a worker at a steady rate, stops allocating after warm-up.
+ */
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <stddef.h>
+#include <new>
+
+namespace ipc::core {
+
+/**
+ * @brief Process wide pool of small blocks in fixed size classes.
+ *
+ * Every thread keeps a cache per size class and only takes the shared lock to move a
+ * batch when that cache runs empty or full. Sizes above the largest class go to the heap.
+ */
+class task_pool {
+public:
+    static constexpr size_t class_count = 4;
+    static constexpr size_t class_sizes[class_count] = {64, 128, 256, 512};
+
+    /**
+     * @brief Returns a block of at least size bytes, throws std::bad_alloc on failure.
+     */
+    static void *allocate(size_t size);
+
+    /**
+     * @brief Recycles a block, size must be the size passed to allocate().
+     */
+    static void deallocate(void *ptr, size_t size) noexcept;
+
+    /**
+     * @brief Frees the blocks parked on the shared lists, thread caches are kept.
+     */
+    static void trim();
+};
+
+/**
+ * @brief Standard allocator backed by task_pool, meant for std::allocate_shared.
+ */
+template <typename T>
+class task_allocator {
+public:
+    using value_type = T;
+
+    task_allocator() noexcept = default;
+
+    template <typename U>
+    task_allocator(const task_allocator<U> &) noexcept {}
+
+    T *allocate(size_t n) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over-aligned types are not supported");
+        return static_cast<T *>(task_pool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept {
+        task_pool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const task_allocator<U> &) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const task_allocator<U> &) const noexcept { return false; }
+};
+
+} // namespace ipc::core
+
+#endif // TASK_POOL_H
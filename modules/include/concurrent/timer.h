@@ -1,31 +1,141 @@
+/**
+ * @file timer.h
+ * @brief Defines the `timer` class, a one-shot or periodic timer owned by a worker.
+ *
+ * The timer is kept in the worker's own timer heap and its callback runs on the worker
+ * thread, between the worker's tasks. Deadlines come from the steady clock
+ * (CLOCK_MONOTONIC on Linux) with the resolution the worker can sleep to, well below
+ * a millisecond, and no other thread is involved.
+ */
+
 #ifndef CONCURRENT_TIMER_H
 #define CONCURRENT_TIMER_H
 
+#include <chrono>
 #include <functional>
 #include <memory>
-
-class worker;
+#include <stdint.h>
+#include "worker.h"
+#include "eventloop.h"
 
 namespace ipc::core {
+
+/**
+ * @class timer
+ * @brief Timer firing on the thread of a worker or an event loop.
+ *
+ * A periodic timer stays on the grid start + N * interval, a late callback does not
+ * delay the following ones. When the worker was busy for several intervals, the missed
+ * expirations are coalesced into one callback and reported by overrun().
+ */
 class timer {
     timer(const timer &) = delete;
     timer(timer &&) = delete;
     timer &operator=(const timer &) = delete;
+    timer &operator=(timer &&) = delete;
 
     class timer_p;
     std::unique_ptr<timer_p> m_impl{nullptr};
-    timer(int ms);
-    ~timer();
 
 public:
     using timeout_callback = std::function<void()>;
 
+    /**
+     * @enum Mode
+     * @brief Whether the timer fires once or every interval.
+     */
+    enum Mode {
+        OneShot,  ///< Fires once, interval after start()
+        Periodic, ///< Fires every interval until stop()
+    };
+
+    /**
+     * @brief Constructor.
+     * @param worker The worker whose thread runs the callback.
+     * @param interval The interval, or the delay of a one-shot timer.
+     * @param mode One-shot or periodic.
+     */
+    explicit timer(worker_ptr worker, std::chrono::microseconds interval = std::chrono::microseconds(0), Mode mode = Periodic);
+
+    /**
+     * @brief Constructor.
+     * @param loop The event loop whose thread runs the callback.
+     * @param interval The interval, or the delay of a one-shot timer.
+     * @param mode One-shot or periodic.
+     */
+    explicit timer(evloop_ptr loop, std::chrono::microseconds interval = std::chrono::microseconds(0), Mode mode = Periodic);
+
+    /**
+     * @brief Destructor, stops the timer and waits for a callback in progress.
+     *
+     * The callback must not wait on the thread destroying the timer. From within the
+     * callback itself the timer is destroyed without waiting.
+     */
+    ~timer();
+
+    /**
+     * @brief Sets the function called on expiration, may be changed while running.
+     */
     void set_callback(const timeout_callback &callback);
+
+    /**
+     * @brief Sets the interval in milliseconds, applies from the next start().
+     */
     void set_interval(int ms);
+
+    /**
+     * @brief Sets the interval, applies from the next start().
+     */
+    void set_interval(std::chrono::microseconds interval);
+
+    /**
+     * @brief Sets one-shot or periodic mode, applies from the next start().
+     */
+    void set_mode(Mode mode);
+
+    /**
+     * @brief Returns whether the timer is armed.
+     */
     bool is_running() const;
+
+    /**
+     * @brief Arms the timer one interval from now, restarts it if running.
+     */
     void start();
+
+    /**
+     * @brief Disarms the timer, a callback already running on the worker thread is waited
+     *        for unless stop() is called from it.
+     */
     void stop();
+
+    /**
+     * @brief Returns the expirations since start(), coalesced ones included.
+     */
+    uint64_t expirations() const;
+
+    /**
+     * @brief Returns how many expirations the last callback stood for beyond the first.
+     */
+    uint64_t overrun() const;
 };
+
+using timer_ptr = std::shared_ptr<timer>;
+
+/**
+ * @brief Factory function to create a timer on a worker.
+ */
+static inline timer_ptr make_timer(worker_ptr worker, std::chrono::microseconds interval, timer::Mode mode = timer::Periodic) {
+    return std::make_shared<timer>(std::move(worker), interval, mode);
+}
+
+/**
+ * @brief Factory function to create a timer on an event loop.
+ */
+static inline timer_ptr make_timer(evloop_ptr loop, std::chrono::microseconds interval, timer::Mode mode = timer::Periodic) {
+    return std::make_shared<timer>(std::move(loop), interval, mode);
+}
+
 } // namespace ipc::core
 
-#endif // CONCURRENT_TIMER_H
\ No newline at end of file
+#endif // CONCURRENT_TIMER_H
@@ -10,8 +10,12 @@
 #define WORKER_H
 
 #include "task.h"
+#include "light_task.h"
 #include "task_helpers.h"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <thread>
@@ -44,6 +48,59 @@ public:
         Exited,    ///< Worker has exited
     };
 
+    /**
+     * @enum Priority
+     * @brief Lanes a task can be queued in, each lane is FIFO.
+     *
+     * Tasks with a deadline run earliest deadline first, ahead of Normal and Low. They run
+     * ahead of High only once due (within a millisecond), otherwise High goes first.
+     */
+    enum Priority {
+        High,   ///< Latency-critical work, e.g. control messages
+        Normal, ///< Default lane
+        Low,    ///< Bulk work, runs when nothing else is queued
+    };
+
+    /**
+     * @struct batch_stats
+     * @brief Statistics of the batches the worker thread drained from its queue.
+     */
+    struct batch_stats {
+        size_t batches = 0;   ///< Number of batches drained
+        size_t tasks = 0;     ///< Number of tasks taken in those batches
+        size_t last_size = 0; ///< Size of the most recent batch
+        size_t max_size = 0;  ///< Largest batch so far
+        size_t late = 0;      ///< Deadline tasks started after their deadline
+    };
+
+    /**
+     * @class timer_handle
+     * @brief Handle to a delayed or periodic function posted to the worker.
+     */
+    class timer_handle {
+        friend class worker;
+        std::shared_ptr<std::atomic<bool>> m_cancelled{nullptr};
+
+    public:
+        /**
+         * @brief Cancels the timer, may be called from any thread.
+         *
+         * A run that already started completes, a periodic timer is not rearmed.
+         */
+        void cancel() {
+            if (m_cancelled != nullptr) {
+                m_cancelled->store(true);
+            }
+        }
+
+        /**
+         * @brief Returns whether the handle refers to a timer that was not cancelled.
+         */
+        bool active() const {
+            return (m_cancelled != nullptr && !m_cancelled->load());
+        }
+    };
+
     /**
      * @brief Constructor that accepts a list of tasks.
      * @param task_list A vector of task_base_ptr representing the tasks.
@@ -104,6 +161,12 @@ public:
      */
     size_t task_count() const;
 
+    /**
+     * @brief Returns the batch statistics of the worker thread.
+     * @return A snapshot of the statistics.
+     */
+    batch_stats stats() const;
+
     /**
      * @brief Assigns the worker to a specific CPU.
      * @param cpu The CPU to assign the worker to.
@@ -116,12 +179,70 @@ public:
      */
     void add_task(task_base_ptr task);
 
+    /**
+     * @brief Adds a task to the worker in a priority lane.
+     * @param task A shared pointer to the task to be added.
+     * @param priority The lane, add_task(task) uses Normal.
+     */
+    void add_task(task_base_ptr task, Priority priority);
+
+    /**
+     * @brief Adds a task that should start before a deadline.
+     *
+     * Deadline tasks run earliest deadline first, ahead of the Normal and Low lanes, and
+     * ahead of the High lane once due. A missed deadline does not drop the task, it is
+     * counted in batch_stats::late.
+     *
+     * @param task A shared pointer to the task to be added.
+     * @param deadline The time the task should have started by.
+     */
+    void add_task(task_base_ptr task, std::chrono::steady_clock::time_point deadline);
+
     /**
      * @brief Adds a weak task to the worker.
      * @param task A weak pointer to the task to be added.
      */
     void add_weak_task(task_base_weak_ptr task);
 
+    /**
+     * @brief Runs a function on the worker thread once a delay has elapsed.
+     *
+     * The timer is kept by the worker thread itself, which sleeps until the earliest
+     * timer is due, so no other thread or global tick is involved. Due timers run
+     * before queued tasks, and only while the worker is Running.
+     *
+     * @param delay The time to wait before running the function.
+     * @param func The function to run.
+     * @return A handle to cancel the timer.
+     */
+    timer_handle post_after(std::chrono::steady_clock::duration delay, std::function<void()> func);
+
+    /**
+     * @brief Runs a function on the worker thread every period, the first run after one period.
+     *
+     * Runs missed while the worker was busy or stopped are folded into one, see post_at().
+     *
+     * @param period The interval between runs, must be positive.
+     * @param func The function to run.
+     * @return A handle to cancel the timer, inactive if the period is not positive.
+     */
+    timer_handle post_every(std::chrono::steady_clock::duration period, std::function<void()> func);
+
+    /**
+     * @brief Runs a function on the worker thread at a deadline, then every period if positive.
+     *
+     * Periodic deadlines stay on the grid deadline + N * period, a late run does not shift
+     * the following ones. Expirations that passed while the worker was busy or stopped are
+     * folded into a single run, the function receives how many it stands for.
+     *
+     * @param deadline The time of the first run, on the steady (CLOCK_MONOTONIC) clock.
+     * @param period The interval between runs, zero or negative for a single run.
+     * @param func The function to run, gets the number of expirations, at least 1.
+     * @return A handle to cancel the timer.
+     */
+    timer_handle post_at(std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration period,
+                         std::function<void(uint64_t)> func);
+
     /**
      * @brief Resets the worker.
      */
@@ -146,7 +267,7 @@ public:
     auto add_task(F func, std::function<void(ipc::core::task_base_ptr)> callback, Args &&...args) {
         auto new_task = make_task(std::move(func), std::move(callback), std::forward<Args>(args)...);
         add_task(new_task);
-        return std::move(new_task);
+        return new_task;
     }
 
     /**
@@ -162,11 +283,15 @@ public:
     auto add_task(R (*func)(Args...), std::function<void(ipc::core::task_base_ptr)> callback, Args &&...args) {
         auto new_task = make_task(func, std::move(callback), std::forward<Args>(args)...);
         add_task(new_task);
-        return std::move(new_task);
+        return new_task;
     }
 
     /**
      * @brief Template method to add a task without a callback.
+     *
+     * The task is a pooled light_task, it only synchronizes if get() is called on it.
+     * The arguments are stored by value.
+     *
      * @tparam F The type of the function.
      * @tparam Args The types of the arguments.
      * @param func The function to be executed as a task.
@@ -175,9 +300,9 @@ public:
      */
     template <typename F, typename... Args>
     auto add_nocallback_task(F func, Args &&...args) {
-        auto new_task = make_task(std::move(func), std::function<void(ipc::core::task_base_ptr)>(nullptr), std::forward<Args>(args)...);
+        auto new_task = make_light_task(std::move(func), std::forward<Args>(args)...);
         add_task(new_task);
-        return std::move(new_task);
+        return new_task;
     }
 };
 
@@ -0,0 +1,187 @@
+/**
+ * @file worker_pool.h
+ * @brief Defines a pool of worker threads sharing their tasks by work stealing.
+ *
+ * Tasks posted from outside the pool are dealt round-robin to the threads, tasks
+ * posted from a task running in the pool stay on that thread. An idle thread steals
+ * from a randomly chosen busy one, so load evens out without choosing a worker per task.
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "task.h"
+#include "light_task.h"
+#include "task_helpers.h"
+#include "worker.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ipc::core {
+
+/**
+ * @class worker_pool
+ * @brief Runs tasks on a fixed number of threads with work stealing.
+ *
+ * The state follows worker::State, tasks are only executed while Running.
+ * Tasks do not run in the order they were added.
+ */
+class worker_pool {
+    worker_pool(const worker_pool &) = delete;
+    worker_pool(worker_pool &&) = delete;
+    worker_pool &operator=(const worker_pool &) = delete;
+    worker_pool &operator=(worker_pool &&) = delete;
+
+    class impl;
+    std::unique_ptr<worker_pool::impl> m_impl{nullptr};
+
+public:
+    /**
+     * @brief Constructor.
+     * @param count Number of threads, 0 uses one per CPU.
+     */
+    explicit worker_pool(size_t count = 0);
+
+    /**
+     * @brief Destructor, quits and joins the threads.
+     */
+    ~worker_pool();
+
+    /**
+     * @brief Returns the number of threads.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the current state of the pool, see worker::State.
+     */
+    int state() const;
+
+    /**
+     * @brief Starts executing tasks.
+     */
+    void start();
+
+    /**
+     * @brief Stops executing tasks, queued tasks are kept.
+     */
+    void stop();
+
+    /**
+     * @brief Quits all threads, queued tasks are dropped.
+     */
+    void quit();
+
+    /**
+     * @brief Joins all threads.
+     */
+    void join();
+
+    /**
+     * @brief Returns the count of executed tasks.
+     */
+    size_t executed_count() const;
+
+    /**
+     * @brief Returns the count of queued tasks.
+     */
+    size_t task_count() const;
+
+    /**
+     * @brief Returns the count of tasks taken from another thread.
+     */
+    size_t stolen_count() const;
+
+    /**
+     * @brief Assigns one thread to a specific CPU.
+     * @param index The thread index, less than size().
+     * @param cpu The CPU to assign the thread to.
+     */
+    void assign_to(size_t index, int cpu);
+
+    /**
+     * @brief Assigns thread N to CPU first_cpu + N.
+     * @param first_cpu The CPU of the first thread.
+     */
+    void assign_to(int first_cpu);
+
+    /**
+     * @brief Adds a task to the pool.
+     * @param task A shared pointer to the task to be added.
+     */
+    void add_task(task_base_ptr task);
+
+    /**
+     * @brief Adds a weak task to the pool.
+     * @param task A weak pointer to the task to be added.
+     */
+    void add_weak_task(task_base_weak_ptr task);
+
+    /**
+     * @brief Template method to add a task with a callback.
+     * @tparam F The type of the function.
+     * @tparam Args The types of the arguments.
+     * @param func The function to be executed as a task.
+     * @param callback The callback function to be called after task completion.
+     * @param args The arguments to be passed to the function.
+     * @return A shared pointer to the created task.
+     */
+    template <typename F, typename... Args>
+    auto add_task(F func, std::function<void(ipc::core::task_base_ptr)> callback, Args &&...args) {
+        auto new_task = make_task(std::move(func), std::move(callback), std::forward<Args>(args)...);
+        add_task(new_task);
+        return new_task;
+    }
+
+    /**
+     * @brief Template method to add a task with a callback (function pointer version).
+     * @tparam R The return type of the function.
+     * @tparam Args The types of the arguments.
+     * @param func The function to be executed as a task.
+     * @param callback The callback function to be called after task completion.
+     * @param args The arguments to be passed to the function.
+     * @return A shared pointer to the created task.
+     */
+    template <typename R, typename... Args>
+    auto add_task(R (*func)(Args...), std::function<void(ipc::core::task_base_ptr)> callback, Args &&...args) {
+        auto new_task = make_task(func, std::move(callback), std::forward<Args>(args)...);
+        add_task(new_task);
+        return new_task;
+    }
+
+    /**
+     * @brief Template method to add a task without a callback.
+     *
+     * The task is a pooled light_task, it only synchronizes if get() is called on it.
+     * The arguments are stored by value.
+     *
+     * @tparam F The type of the function.
+     * @tparam Args The types of the arguments.
+     * @param func The function to be executed as a task.
+     * @param args The arguments to be passed to the function.
+     * @return A shared pointer to the created task.
+     */
+    template <typename F, typename... Args>
+    auto add_nocallback_task(F func, Args &&...args) {
+        auto new_task = make_light_task(std::move(func), std::forward<Args>(args)...);
+        add_task(new_task);
+        return new_task;
+    }
+};
+
+using worker_pool_ptr = std::shared_ptr<worker_pool>;
+
+/**
+ * @brief Factory function to create a worker pool.
+ * @param count Number of threads, 0 uses one per CPU.
+ * @return A shared pointer to the created pool.
+ */
+static inline worker_pool_ptr make_worker_pool(size_t count = 0) {
+    return std::make_shared<worker_pool>(count);
+}
+
+} // namespace ipc::core
+
+#endif // WORKER_POOL_H
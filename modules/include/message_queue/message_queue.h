@@ -1,6 +1,7 @@
 #ifndef MESSAGE_QUEUE_H
 #define MESSAGE_QUEUE_H
 
+#include "concurrent/buffer_pool.h"
 #include <memory>
 #include <stdint.h>
 #include <string>
@@ -25,6 +26,15 @@ public:
     int size();
     int send(const char *buff, size_t size);
     int receive(char *buff, size_t size);
+
+    /**
+     * @fn receive
+     * @brief Receive one message into a pooled buffer, buff is reused when it is not shared
+     *
+     * @param buff      Set to the message, the buffer size is the message size
+     * @return int      Message size, otherwise -1
+     */
+    int receive(buffer_ref &buff);
 };
 } // namespace ipc::core
 
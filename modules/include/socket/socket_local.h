@@ -1,56 +1,159 @@
 #ifndef SOCKET_LOCAL_H
 #define SOCKET_LOCAL_H
+#include "concurrent/buffer_pool.h"
 #include <memory>
+#include <stdint.h>
 #include <string>
 
 namespace ipc::core {
 
+/**
+ * @brief Local (Unix domain) socket type
+ *
+ * SeqPacket keeps message boundaries, every send is delivered by exactly one recv,
+ * so no framing is needed. Stream is a plain byte stream.
+ */
+enum class local_socket_type : int32_t {
+    SeqPacket = 0,
+    Stream,
+};
+
+/**
+ * @brief Credentials of the process on the other end of a local connection
+ */
+struct local_peer_cred {
+    int32_t pid = -1;
+    uint32_t uid = 0;
+    uint32_t gid = 0;
+};
+
+/**
+ * @brief Connection accepted by socket_local_server
+ */
 class accept_client {
 private:
+    friend class socket_local_server;
     class impl;
     std::unique_ptr<impl> m_impl{nullptr};
+    accept_client(const accept_client &) = delete;
+    accept_client &operator=(const accept_client &) = delete;
+
+    explicit accept_client(std::unique_ptr<impl> impl);
 
 public:
-    accept_client();
+    ~accept_client();
+
+    int close();
+    bool opened() const;
+    int send(const char *data, size_t size);
+    int recv(char *buff, size_t size);
+
+    /**
+     * @fn recv
+     * @brief Receive into a pooled buffer, buff is reused when it is not shared
+     *
+     * @param buff      Set to the received data
+     * @param capacity  Most bytes to receive, a longer SeqPacket message is truncated
+     * @return int      Received bytes, 0 if the peer closed, otherwise -1
+     */
+    int recv(buffer_ref &buff, size_t capacity);
 
-    
+    /**
+     * @fn handle
+     * @brief Native socket descriptor, e.g. for registering with epoll
+     */
+    int handle() const;
 
+    /**
+     * @fn peer_cred
+     * @brief Credentials of the connecting process, taken when the connection was accepted
+     */
+    const local_peer_cred &peer_cred() const;
 };
 
+using accept_client_ptr = std::shared_ptr<accept_client>;
+
+/**
+ * @brief Local socket server
+ *
+ * A path starting with '@' is bound in the Linux abstract namespace, no file is
+ * created and the name disappears with the last socket. Otherwise the socket file
+ * is replaced on bind and removed on close.
+ */
 class socket_local_server {
 private:
     class impl;
     std::unique_ptr<impl> m_impl{nullptr};
+    socket_local_server(const socket_local_server &) = delete;
+    socket_local_server &operator=(const socket_local_server &) = delete;
 
 public:
-    socket_local_server(const std::string &path);
+    socket_local_server(const std::string &path, local_socket_type type = local_socket_type::SeqPacket);
     ~socket_local_server();
 
     int open();
     int close();
+    bool opened() const;
     int bind();
     int listen(size_t max);
-    int 
+
+    /**
+     * @fn accept
+     * @brief Wait for an incoming connection
+     *
+     * @return accept_client_ptr    Connected client, nullptr on failure
+     */
+    accept_client_ptr accept();
+
+    int handle() const;
+    const std::string &path() const;
 };
 
+/**
+ * @brief Local socket client, connects to a socket_local_server of the same type
+ */
 class socket_local_client {
 private:
     class impl;
     std::unique_ptr<impl> m_impl{nullptr};
+    socket_local_client(const socket_local_client &) = delete;
+    socket_local_client &operator=(const socket_local_client &) = delete;
 
 public:
-    socket_local_client();
+    socket_local_client(local_socket_type type = local_socket_type::SeqPacket);
     ~socket_local_client();
 
     int open();
     int close();
+    bool opened() const;
     int connect(const std::string &path);
     int disconnect();
 
     int send(const char *data, size_t size);
     int recv(char *buff, size_t size);
+
+    /**
+     * @fn recv
+     * @brief Receive into a pooled buffer, buff is reused when it is not shared
+     *
+     * @param buff      Set to the received data
+     * @param capacity  Most bytes to receive, a longer SeqPacket message is truncated
+     * @return int      Received bytes, 0 if the peer closed, otherwise -1
+     */
+    int recv(buffer_ref &buff, size_t capacity);
+
+    int handle() const;
+
+    /**
+     * @fn peer_cred
+     * @brief Get the credentials of the server process
+     *
+     * @param cred
+     * @return int      0 if success, otherwise -1
+     */
+    int peer_cred(local_peer_cred &cred);
 };
 
 } // namespace ipc::core
 
-#endif // SOCKET_LOCAL_H
\ No newline at end of file
+#endif // SOCKET_LOCAL_H
@@ -0,0 +1,143 @@
+#ifndef SOCKET_TCP_H
+#define SOCKET_TCP_H
+#include "concurrent/buffer_pool.h"
+#include "concurrent/worker.h"
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ipc::core {
+
+/**
+ * @brief Socket option set applied to TCP connections
+ */
+enum class tcp_profile : int32_t {
+    System = 0, ///< Options are left at the system defaults
+    LowLatency, ///< No Nagle, quick acks, busy polling where permitted, small buffers
+    Bulk,       ///< Corked writes and large buffers, call flush() after a burst
+};
+
+/**
+ * @brief Connection accepted by socket_tcp_server
+ */
+class tcp_connection {
+private:
+    friend class socket_tcp_server;
+    class impl;
+    std::unique_ptr<impl> m_impl{nullptr};
+    tcp_connection(const tcp_connection &) = delete;
+    tcp_connection &operator=(const tcp_connection &) = delete;
+
+    explicit tcp_connection(std::unique_ptr<impl> impl);
+
+public:
+    ~tcp_connection();
+
+    int close();
+    bool opened() const;
+    int send(const char *data, size_t size);
+    int recv(char *buff, size_t size);
+
+    /**
+     * @fn recv
+     * @brief Receive into a pooled buffer, buff is reused when it is not shared
+     *
+     * @param buff      Set to the received data
+     * @param capacity  Most bytes to receive
+     * @return int      Received bytes, 0 if the peer closed, otherwise -1
+     */
+    int recv(buffer_ref &buff, size_t capacity);
+
+    /**
+     * @fn flush
+     * @brief Send data held back by the Bulk profile now
+     *
+     * @return int      0 if success, otherwise -1
+     */
+    int flush();
+
+    int handle() const;
+
+    /**
+     * @fn shard
+     * @brief Index of the listener (and worker) that accepted this connection
+     */
+    size_t shard() const;
+};
+
+using tcp_connection_ptr = std::shared_ptr<tcp_connection>;
+
+/**
+ * @brief Options of socket_tcp_server
+ */
+struct tcp_server_options {
+    std::string ip = "0.0.0.0";
+    uint16_t port = 0;               ///< 0 picks a free port, see socket_tcp_server::port()
+    uint32_t backlog = 128;          ///< Listen backlog of every listener
+    bool pin_workers = true;         ///< Pin worker N to CPU N with worker::assign_to
+    bool cpu_steering = false;       ///< Accept on the listener of the CPU that received the SYN, requires pin_workers
+    size_t accept_batch = 16;        ///< Most connections accepted per accept task run
+    tcp_profile profile = tcp_profile::System; ///< Applied to every accepted connection
+};
+
+/**
+ * @brief TCP server sharded over workers
+ *
+ * Every worker owns its own listening socket bound to the same port with SO_REUSEPORT,
+ * the kernel distributes incoming connections over the listeners, so there is no
+ * single accept thread. The listeners are non-blocking, a shared poller thread posts an
+ * accept task to a listener's worker only when connections are pending, so an idle
+ * server keeps no worker busy. The connection handler runs on the worker that accepted
+ * the connection and may keep posting work there.
+ *
+ * With cpu_steering a BPF program selects listener N for connections processed on
+ * CPU N. This keeps a connection on the core that handled its packets, it is most
+ * effective with one worker per CPU.
+ */
+class socket_tcp_server {
+public:
+    using connection_handler = std::function<void(tcp_connection_ptr)>;
+
+private:
+    class impl;
+    std::unique_ptr<impl> m_impl{nullptr};
+    socket_tcp_server(const socket_tcp_server &) = delete;
+    socket_tcp_server &operator=(const socket_tcp_server &) = delete;
+
+public:
+    socket_tcp_server(const std::vector<worker_ptr> &workers, const tcp_server_options &options, connection_handler handler);
+    ~socket_tcp_server();
+
+    /**
+     * @fn start
+     * @brief Open, bind and listen one socket per worker and watch them for pending
+     *        connections, idle workers are started
+     *
+     * @return int      0 if success, otherwise -1
+     */
+    int start();
+
+    /**
+     * @fn stop
+     * @brief Stop accepting, listeners are closed once their accept task returned
+     *
+     * @return int      0 if success, otherwise -1
+     */
+    int stop();
+
+    bool running() const;
+
+    /**
+     * @fn port
+     * @brief Port the listeners are bound to, valid after start()
+     */
+    uint16_t port() const;
+
+    size_t shard_count() const;
+};
+
+} // namespace ipc::core
+
+#endif // SOCKET_TCP_H
@@ -0,0 +1,105 @@
+#ifndef SOCKET_TCP_POOL_H
+#define SOCKET_TCP_POOL_H
+#include "concurrent/buffer_pool.h"
+#include "socket/socket_tcp.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+namespace ipc::core {
+
+/**
+ * @brief Options of tcp_client_pool, limits apply per remote endpoint
+ */
+struct tcp_pool_options {
+    size_t min_idle = 1;                 ///< Connections kept open even without traffic
+    size_t max_connections = 8;          ///< Most connections opened to one endpoint
+    size_t max_pipeline = 32;            ///< Most requests in flight on one connection
+    uint32_t connect_timeout_ms = 1000;  ///< Longest time a connect may block
+    uint32_t request_timeout_ms = 5000;  ///< A connection whose oldest request is older is dropped, also bounds a blocked send
+    uint32_t idle_timeout_ms = 30000;    ///< Connections above min_idle unused for longer are closed
+    uint32_t health_interval_ms = 500;   ///< Period of the idle/timeout/refill check
+    tcp_profile profile = tcp_profile::LowLatency; ///< Applied to every connection
+    size_t max_frame = 16 * 1024 * 1024; ///< Largest response accepted
+};
+
+/**
+ * @brief Pool of warm TCP client connections with request pipelining
+ *
+ * Requests and responses are length-prefixed frames (see cframed_socket). Several
+ * requests may be in flight on one connection, the server must answer them in the
+ * order they were sent. One background thread reads the responses of all
+ * connections, completes the requests in order and periodically closes dead, stuck
+ * or surplus idle connections. Connections are reopened up to min_idle by a second
+ * thread, so an unreachable endpoint never holds up the reading of responses.
+ *
+ * Handlers run on the background thread and must not block it.
+ */
+class tcp_client_pool {
+public:
+    /**
+     * @brief Called once per request, status is 0 with the response, otherwise -1
+     *        with an empty buffer (connection lost, timed out or pool closed)
+     */
+    using response_handler = std::function<void(int status, buffer_ref response)>;
+
+private:
+    class impl;
+    std::unique_ptr<impl> m_impl{nullptr};
+    tcp_client_pool(const tcp_client_pool &) = delete;
+    tcp_client_pool &operator=(const tcp_client_pool &) = delete;
+
+public:
+    explicit tcp_client_pool(const tcp_pool_options &options = tcp_pool_options());
+    ~tcp_client_pool();
+
+    /**
+     * @fn warm
+     * @brief Open min_idle connections to an endpoint ahead of the first request
+     *
+     * @param ip
+     * @param port
+     * @return int      Number of open connections to the endpoint, -1 if none could be opened
+     */
+    int warm(const std::string &ip, uint16_t port);
+
+    /**
+     * @fn request
+     * @brief Send a request on the least loaded connection, a new connection is opened
+     *        when all are busy and max_connections is not reached
+     *
+     * @param ip
+     * @param port
+     * @param data      Request payload
+     * @param size
+     * @param handler   Called with the response
+     * @return int      0 if the request was sent, otherwise -1 and handler is not called
+     */
+    int request(const std::string &ip, uint16_t port, const char *data, size_t size, response_handler handler);
+
+    /**
+     * @fn request
+     * @brief Send a request, the future throws std::runtime_error if it fails
+     */
+    std::future<buffer_ref> request(const std::string &ip, uint16_t port, const char *data, size_t size);
+
+    /**
+     * @fn connections
+     * @brief Number of open connections to an endpoint
+     */
+    size_t connections(const std::string &ip, uint16_t port) const;
+
+    /**
+     * @fn close
+     * @brief Close all connections and fail the requests in flight, the pool cannot be reused
+     *
+     * A refill connect in progress is waited for, at most connect_timeout_ms.
+     */
+    void close();
+};
+
+} // namespace ipc::core
+
+#endif // SOCKET_TCP_POOL_H
@@ -0,0 +1,102 @@
+#ifndef SOCKET_UDP_H
+#define SOCKET_UDP_H
+#include "concurrent/buffer_pool.h"
+#include "concurrent/worker.h"
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ipc::core {
+
+/**
+ * @brief How a multicast_receiver spreads datagrams over its workers
+ *
+ * The receivers share the port with SO_REUSEPORT, but Linux hands a copy of every
+ * multicast datagram to each matching socket instead of balancing between them,
+ * so the split has to be chosen explicitly.
+ */
+enum class multicast_fanout : int32_t {
+    ByGroup = 0, ///< Groups are dealt round-robin to the workers, each group is read by one worker
+    ByKey,       ///< Every worker joins all groups, a kernel filter keeps key % workers == worker index
+    Replicate,   ///< Every worker receives every datagram
+};
+
+/**
+ * @brief Multicast group to join, an empty source joins any source
+ */
+struct multicast_group {
+    std::string group;
+    std::string source = "";
+};
+
+/**
+ * @brief Options of multicast_receiver
+ */
+struct multicast_receiver_options {
+    std::vector<multicast_group> groups;
+    uint16_t port = 0;
+    std::string iface = "0.0.0.0";              ///< Interface to join on, "127.0.0.1" for loopback feeds
+    multicast_fanout fanout = multicast_fanout::ByGroup;
+    uint32_t key_offset = 0;                    ///< ByKey, payload offset of a big endian 32-bit key
+    bool pin_workers = true;                    ///< Pin worker N to CPU N with worker::assign_to
+    uint32_t recv_buff_size = 0;                ///< SO_RCVBUF of every socket, 0 keeps the system default
+    size_t recv_batch = 64;                     ///< Most datagrams handled per receive task run
+    size_t max_datagram = 65536;                ///< Largest datagram received, also the pooled buffer size
+};
+
+/**
+ * @brief Multicast receiver with one socket per worker
+ *
+ * The sockets are non-blocking, a shared poller thread posts a receive task to a socket's
+ * worker only when datagrams are queued, so an idle receiver keeps no worker busy.
+ * The handler runs on the worker that owns the socket. A datagram_handler gets a view
+ * valid only during the call, a buffer_handler gets a pooled buffer it may keep or pass
+ * on (e.g. into a message) without copying.
+ */
+class multicast_receiver {
+public:
+    using datagram_handler = std::function<void(const char *data, size_t size, size_t shard)>;
+    using buffer_handler = std::function<void(buffer_ref data, size_t shard)>;
+
+private:
+    class impl;
+    std::unique_ptr<impl> m_impl{nullptr};
+    multicast_receiver(const multicast_receiver &) = delete;
+    multicast_receiver &operator=(const multicast_receiver &) = delete;
+
+public:
+    multicast_receiver(const std::vector<worker_ptr> &workers, const multicast_receiver_options &options, datagram_handler handler);
+    multicast_receiver(const std::vector<worker_ptr> &workers, const multicast_receiver_options &options, buffer_handler handler);
+    ~multicast_receiver();
+
+    /**
+     * @fn start
+     * @brief Open, bind and join the groups on one socket per worker and watch them for
+     *        datagrams, idle workers are started
+     *
+     * @return int      0 if success, otherwise -1
+     */
+    int start();
+
+    /**
+     * @fn stop
+     * @brief Stop receiving, sockets leave their groups when their receive task returned
+     *
+     * @return int      0 if success, otherwise -1
+     */
+    int stop();
+
+    bool running() const;
+
+    /**
+     * @fn shard_count
+     * @brief Number of sockets, ByGroup uses at most one per group
+     */
+    size_t shard_count() const;
+};
+
+} // namespace ipc::core
+
+#endif // SOCKET_UDP_H
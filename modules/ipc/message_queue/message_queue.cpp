@@ -67,6 +67,17 @@ public:
     bool opened() const {
         return (m_created.load() || m_opened.load());
     }
+
+    using cmessage_queue::receive;
+
+    int receive(buffer_ref &buff) {
+        if (!buffer_pool::reserve(buff, m_msgsize)) {
+            return -1;
+        }
+        int ret = cmessage_queue::receive(buff.data(), buff.capacity());
+        buff.resize(ret > 0 ? static_cast<size_t>(ret) : 0);
+        return ret;
+    }
 };
 
 /**
@@ -107,5 +118,8 @@ int message_queue::send(const char *buff, size_t size) {
 int message_queue::receive(char *buff, size_t size) {
     return m_impl->receive(buff, size);
 }
+int message_queue::receive(buffer_ref &buff) {
+    return m_impl->receive(buff);
+}
 
 } // namespace ipc::core
@@ -0,0 +1,224 @@
+#include "socket/socket_local.h"
+#include "osac/csocket.h"
+#include <atomic>
+#include <cstdio>
+
+namespace ipc::core {
+
+static inline int32_t local_socket_type_of(local_socket_type type) {
+    return static_cast<int32_t>(type == local_socket_type::Stream ? csocket::Type::SocketHostStream : csocket::Type::SocketHost);
+}
+
+static inline int local_recv_pooled(csocket &socket, buffer_ref &buff, size_t capacity) {
+    if (!buffer_pool::reserve(buff, capacity)) {
+        return -1;
+    }
+    int ret = socket.receive(buff.data(), buff.capacity());
+    buff.resize(ret > 0 ? static_cast<size_t>(ret) : 0);
+    return ret;
+}
+
+static inline void local_peer_cred_from(local_peer_cred &cred, const SOCKET_CRED &sk_cred) {
+    cred.pid = sk_cred.s32Pid;
+    cred.uid = sk_cred.u32Uid;
+    cred.gid = sk_cred.u32Gid;
+}
+
+class accept_client::impl {
+    friend class accept_client;
+
+    std::unique_ptr<csocket> m_socket{nullptr};
+    local_peer_cred m_cred{};
+
+public:
+    explicit impl(csocket *socket) :
+        m_socket(socket) {
+        SOCKET_CRED stCred;
+        if (m_socket->get_peer_cred(stCred) == 0) {
+            local_peer_cred_from(m_cred, stCred);
+        }
+    }
+
+    int close() {
+        int ret = -1;
+        if (m_socket->is_open()) {
+            ret = m_socket->close();
+        }
+        return ret;
+    }
+};
+
+accept_client::accept_client(std::unique_ptr<impl> impl) :
+    m_impl(std::move(impl)) {
+}
+accept_client::~accept_client() {
+}
+
+int accept_client::close() {
+    return m_impl->close();
+}
+bool accept_client::opened() const {
+    return m_impl->m_socket->is_open() != 0;
+}
+int accept_client::send(const char *data, size_t size) {
+    return m_impl->m_socket->send(data, size);
+}
+int accept_client::recv(char *buff, size_t size) {
+    return m_impl->m_socket->receive(buff, size);
+}
+int accept_client::recv(buffer_ref &buff, size_t capacity) {
+    return local_recv_pooled(*m_impl->m_socket, buff, capacity);
+}
+int accept_client::handle() const {
+    return static_cast<int>(m_impl->m_socket->get_handle());
+}
+const local_peer_cred &accept_client::peer_cred() const {
+    return m_impl->m_cred;
+}
+
+class socket_local_server::impl : public csocket {
+    friend class socket_local_server;
+
+    std::string m_path = "";
+    std::atomic<bool> m_bound{false};
+
+public:
+    impl(const std::string &path, local_socket_type type) :
+        csocket(local_socket_type_of(type), static_cast<int32_t>(csocket::Mode::Server)),
+        m_path(path),
+        m_bound{false} {
+    }
+
+    ~impl() {
+        close();
+    }
+
+    int bind() {
+        int ret = csocket::bind(m_path.c_str());
+        if (ret == 0) {
+            m_bound.store(true);
+        }
+        return ret;
+    }
+
+    int close() {
+        int ret = -1;
+        if (is_open()) {
+            ret = csocket::close();
+        }
+        /* Abstract names vanish with the socket, filesystem names must be removed */
+        if (m_bound.exchange(false) && !m_path.empty() && m_path[0] != '@') {
+            std::remove(m_path.c_str());
+        }
+        return ret;
+    }
+};
+
+/**
+ * @fn socket_local_server(const std::string &path, local_socket_type type)
+ * @brief Construct a new local socket server object
+ *
+ * @param path      Socket file path, or '@name' for an abstract address
+ * @param type      SeqPacket or Stream
+ */
+socket_local_server::socket_local_server(const std::string &path, local_socket_type type) :
+    m_impl(std::make_unique<socket_local_server::impl>(path, type)) {
+}
+socket_local_server::~socket_local_server() {
+}
+
+int socket_local_server::open() {
+    return m_impl->open();
+}
+int socket_local_server::close() {
+    return m_impl->close();
+}
+bool socket_local_server::opened() const {
+    return m_impl->is_open() != 0;
+}
+int socket_local_server::bind() {
+    return m_impl->bind();
+}
+int socket_local_server::listen(size_t max) {
+    return m_impl->listen(static_cast<uint32_t>(max));
+}
+accept_client_ptr socket_local_server::accept() {
+    csocket *poSocket = m_impl->accept();
+    if (poSocket == nullptr) {
+        return nullptr;
+    }
+    return accept_client_ptr(new accept_client(std::make_unique<accept_client::impl>(poSocket)));
+}
+int socket_local_server::handle() const {
+    return static_cast<int>(m_impl->get_handle());
+}
+const std::string &socket_local_server::path() const {
+    return m_impl->m_path;
+}
+
+class socket_local_client::impl : public csocket {
+    friend class socket_local_client;
+
+public:
+    explicit impl(local_socket_type type) :
+        csocket(local_socket_type_of(type), static_cast<int32_t>(csocket::Mode::Client)) {
+    }
+
+    int close() {
+        int ret = -1;
+        if (is_open()) {
+            ret = csocket::close();
+        }
+        return ret;
+    }
+};
+
+/**
+ * @fn socket_local_client(local_socket_type type)
+ * @brief Construct a new local socket client object
+ *
+ * @param type      Must match the type of the server
+ */
+socket_local_client::socket_local_client(local_socket_type type) :
+    m_impl(std::make_unique<socket_local_client::impl>(type)) {
+}
+socket_local_client::~socket_local_client() {
+}
+
+int socket_local_client::open() {
+    return m_impl->open();
+}
+int socket_local_client::close() {
+    return m_impl->close();
+}
+bool socket_local_client::opened() const {
+    return m_impl->is_open() != 0;
+}
+int socket_local_client::connect(const std::string &path) {
+    return m_impl->connect(path.c_str(), 0);
+}
+int socket_local_client::disconnect() {
+    return m_impl->disconnect();
+}
+int socket_local_client::send(const char *data, size_t size) {
+    return m_impl->send(data, size);
+}
+int socket_local_client::recv(char *buff, size_t size) {
+    return m_impl->receive(buff, size);
+}
+int socket_local_client::recv(buffer_ref &buff, size_t capacity) {
+    return local_recv_pooled(*m_impl, buff, capacity);
+}
+int socket_local_client::handle() const {
+    return static_cast<int>(m_impl->get_handle());
+}
+int socket_local_client::peer_cred(local_peer_cred &cred) {
+    SOCKET_CRED stCred;
+    int ret = m_impl->get_peer_cred(stCred);
+    if (ret == 0) {
+        local_peer_cred_from(cred, stCred);
+    }
+    return ret;
+}
+
+} // namespace ipc::core
@@ -0,0 +1,179 @@
+#include "socket_poller_p.h"
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace ipc::core {
+
+/* Most events handled per epoll_wait call */
+#define SOCKET_POLLER_EVENTS 64
+
+socket_poller::socket_poller() :
+    m_state(std::make_shared<state>()) {
+    m_state->epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_state->wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_state->epfd < 0 || m_state->wakefd < 0) {
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    if (::epoll_ctl(m_state->epfd, EPOLL_CTL_ADD, m_state->wakefd, &ev) != 0) {
+        return;
+    }
+    m_state->running.store(true);
+    m_thread = std::thread([st = m_state]() {
+        st->run();
+    });
+}
+
+socket_poller::~socket_poller() {
+    if (m_state->running.exchange(false)) {
+        uint64_t one = 1;
+        if (::write(m_state->wakefd, &one, sizeof(one)) < 0) {
+            // Already signalled
+        }
+    }
+    if (m_thread.joinable()) {
+        /* The last reference may be dropped by a handler, the thread keeps the state alive */
+        if (m_thread.get_id() == std::this_thread::get_id()) {
+            m_thread.detach();
+        } else {
+            m_thread.join();
+        }
+    }
+}
+
+socket_poller::state::~state() {
+    if (wakefd >= 0) {
+        ::close(wakefd);
+    }
+    if (epfd >= 0) {
+        ::close(epfd);
+    }
+}
+
+/**
+ * @fn shared
+ * @brief Poller shared by the sockets of the process, its thread stops with the last reference
+ *
+ * @return std::shared_ptr<socket_poller>   nullptr if the poller could not be created
+ */
+std::shared_ptr<socket_poller> socket_poller::shared() {
+    static std::mutex s_mtx;
+    static std::weak_ptr<socket_poller> s_poller;
+    std::unique_lock<std::mutex> lock(s_mtx);
+    auto poller = s_poller.lock();
+    if (poller == nullptr) {
+        poller = std::make_shared<socket_poller>();
+        if (!poller->m_state->running.load()) {
+            return nullptr;
+        }
+        s_poller = poller;
+    }
+    return poller;
+}
+
+/**
+ * @fn add
+ * @brief Watch a socket, the handler must be cheap as it runs on the poller thread
+ *
+ * @param fd        Socket handle, must stay open until remove()
+ * @param handler   Called once when the socket is readable
+ * @param id        Set to the watch id before the handler can be called
+ * @return int      0 if success, otherwise -1
+ */
+int socket_poller::add(int fd, ready_handler handler, uint64_t &id) {
+    auto w = std::make_shared<watch>();
+    w->fd = fd;
+    w->handler = std::move(handler);
+
+    /* The handler finds the watch under the lock, so it sees id set */
+    std::unique_lock<std::mutex> lock(m_state->mtx);
+    id = m_state->next_id++;
+    m_state->watches.emplace(id, std::move(w));
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = id;
+    if (::epoll_ctl(m_state->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        m_state->watches.erase(id);
+        id = 0;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @fn rearm
+ * @brief Call the handler again on the next readiness, no-op once removed
+ *
+ * @return int      0 if success, otherwise -1
+ */
+int socket_poller::rearm(uint64_t id) {
+    std::unique_lock<std::mutex> lock(m_state->mtx);
+    auto it = m_state->watches.find(id);
+    if (it == m_state->watches.end()) {
+        return 0;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = id;
+    return (::epoll_ctl(m_state->epfd, EPOLL_CTL_MOD, it->second->fd, &ev) == 0 ? 0 : -1);
+}
+
+/**
+ * @fn remove
+ * @brief Stop watching, a handler call already in progress may still complete
+ */
+void socket_poller::remove(uint64_t id) {
+    std::unique_lock<std::mutex> lock(m_state->mtx);
+    auto it = m_state->watches.find(id);
+    if (it == m_state->watches.end()) {
+        return;
+    }
+    ::epoll_ctl(m_state->epfd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+    m_state->watches.erase(it);
+}
+
+void socket_poller::state::run() {
+    epoll_event events[SOCKET_POLLER_EVENTS];
+    while (running.load()) {
+        int count = ::epoll_wait(epfd, events, SOCKET_POLLER_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        /* A handler may have released the poller, the remaining events are then dropped */
+        for (int i = 0; i < count && running.load(); i++) {
+            uint64_t id = events[i].data.u64;
+            if (id == 0) {
+                uint64_t value;
+                if (::read(wakefd, &value, sizeof(value)) < 0) {
+                    // Nothing to drain
+                }
+                continue;
+            }
+            /* Ids are never reused, an event of a removed watch finds nothing */
+            std::shared_ptr<watch> w;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                auto it = watches.find(id);
+                if (it != watches.end()) {
+                    w = it->second;
+                }
+            }
+            if (w != nullptr) {
+                try {
+                    w->handler();
+                } catch (...) {
+                    // Do nothing
+                }
+            }
+        }
+    }
+}
+
+} // namespace ipc::core
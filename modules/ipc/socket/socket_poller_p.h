@@ -0,0 +1,93 @@
+#ifndef SOCKET_POLLER_P_H
+#define SOCKET_POLLER_P_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <unordered_map>
+
+namespace ipc::core {
+
+/**
+ * @class socket_poller
+ * @brief One epoll thread telling socket owners when their sockets are readable
+ *
+ * A watch is one-shot: its handler is called once on the poller thread when the socket
+ * becomes readable and not again until rearm(). The owner typically posts a task that
+ * reads until the socket would block and then rearms it, so no worker waits on a socket.
+ */
+class socket_poller {
+    socket_poller(const socket_poller &) = delete;
+    socket_poller &operator=(const socket_poller &) = delete;
+
+public:
+    using ready_handler = std::function<void()>;
+
+    socket_poller();
+    ~socket_poller();
+
+    /**
+     * @fn shared
+     * @brief Poller shared by the sockets of the process, its thread stops with the last reference
+     *
+     * @return std::shared_ptr<socket_poller>   nullptr if the poller could not be created
+     */
+    static std::shared_ptr<socket_poller> shared();
+
+    /**
+     * @fn add
+     * @brief Watch a socket, the handler must be cheap as it runs on the poller thread
+     *
+     * @param fd        Socket handle, must stay open until remove()
+     * @param handler   Called once when the socket is readable
+     * @param id        Set to the watch id before the handler can be called
+     * @return int      0 if success, otherwise -1
+     */
+    int add(int fd, ready_handler handler, uint64_t &id);
+
+    /**
+     * @fn rearm
+     * @brief Call the handler again on the next readiness, no-op once removed
+     *
+     * @return int      0 if success, otherwise -1
+     */
+    int rearm(uint64_t id);
+
+    /**
+     * @fn remove
+     * @brief Stop watching, a handler call already in progress may still complete
+     */
+    void remove(uint64_t id);
+
+private:
+    struct watch {
+        int fd = -1;
+        ready_handler handler{nullptr};
+    };
+
+    /*
+     * Everything the poller thread touches. The thread owns a reference, so a handler
+     * dropping the last socket_poller reference does not free it under the loop.
+     */
+    struct state {
+        ~state();
+        void run();
+
+        int epfd = -1;
+        int wakefd = -1;
+        std::atomic<bool> running{false};
+        std::mutex mtx;
+        std::unordered_map<uint64_t, std::shared_ptr<watch>> watches;
+        uint64_t next_id = 1; ///< Id 0 marks the wakeup event
+    };
+
+    std::shared_ptr<state> m_state;
+    std::thread m_thread;
+};
+
+} // namespace ipc::core
+
+#endif // SOCKET_POLLER_P_H
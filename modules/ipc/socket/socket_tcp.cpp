@@ -0,0 +1,280 @@
+#include "socket/socket_tcp.h"
+#include "osac/csocket.h"
+#include "socket_poller_p.h"
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+
+namespace ipc::core {
+
+class tcp_connection::impl {
+    friend class tcp_connection;
+
+    std::unique_ptr<csocket> m_socket{nullptr};
+    size_t m_shard = 0;
+
+public:
+    impl(csocket *socket, size_t shard) :
+        m_socket(socket),
+        m_shard(shard) {
+    }
+};
+
+tcp_connection::tcp_connection(std::unique_ptr<impl> impl) :
+    m_impl(std::move(impl)) {
+}
+tcp_connection::~tcp_connection() {
+}
+
+int tcp_connection::close() {
+    return m_impl->m_socket->close();
+}
+bool tcp_connection::opened() const {
+    return m_impl->m_socket->is_open() != 0;
+}
+int tcp_connection::send(const char *data, size_t size) {
+    return m_impl->m_socket->send(data, size);
+}
+int tcp_connection::recv(char *buff, size_t size) {
+    return m_impl->m_socket->receive(buff, size);
+}
+int tcp_connection::recv(buffer_ref &buff, size_t capacity) {
+    if (!buffer_pool::reserve(buff, capacity)) {
+        return -1;
+    }
+    int ret = m_impl->m_socket->receive(buff.data(), buff.capacity());
+    buff.resize(ret > 0 ? static_cast<size_t>(ret) : 0);
+    return ret;
+}
+int tcp_connection::flush() {
+    return m_impl->m_socket->flush();
+}
+int tcp_connection::handle() const {
+    return static_cast<int>(m_impl->m_socket->get_handle());
+}
+size_t tcp_connection::shard() const {
+    return m_impl->m_shard;
+}
+
+class socket_tcp_server::impl {
+    friend class socket_tcp_server;
+
+    /* One listener per worker, shared with the accept task that keeps it alive after stop() */
+    struct shard {
+        size_t index = 0;
+        std::weak_ptr<worker> owner{};
+        csocket listener{static_cast<int32_t>(csocket::Type::SocketTcp), static_cast<int32_t>(csocket::Mode::Server)};
+        std::shared_ptr<socket_poller> poller{nullptr};
+        uint64_t watch = 0;
+        std::shared_ptr<std::atomic<bool>> running{nullptr};
+        size_t accept_batch = 0;
+        tcp_profile profile = tcp_profile::System;
+        connection_handler handler{nullptr};
+    };
+    using shard_ptr = std::shared_ptr<shard>;
+
+    std::vector<worker_ptr> m_workers;
+    tcp_server_options m_options;
+    connection_handler m_handler{nullptr};
+    std::vector<shard_ptr> m_shards;
+    std::shared_ptr<std::atomic<bool>> m_running{nullptr};
+    uint16_t m_port = 0;
+    mutable std::mutex m_mtx;
+
+    static void post_accept(shard_ptr sh) {
+        /* The worker is held weakly, a queued accept task must not keep its own worker alive */
+        if (auto wk = sh->owner.lock()) {
+            wk->add_nocallback_task([sh]() {
+                accept_connections(sh);
+            });
+        }
+    }
+
+    /* Posted when the listener is readable, accepts until it would block and waits for the poller again */
+    static void accept_connections(shard_ptr sh) {
+        for (size_t i = 0; i < sh->accept_batch; i++) {
+            if (!sh->running->load()) {
+                return;
+            }
+            int32_t error = 0;
+            csocket *poSocket = sh->listener.accept(&error);
+            if (poSocket == nullptr) {
+                /* The connection was reset before it was accepted, others may be pending */
+                if (error == EINTR || error == ECONNABORTED) {
+                    continue;
+                }
+                sh->poller->rearm(sh->watch);
+                return;
+            }
+            /* Best effort, a connection without the profile still works */
+            if (sh->profile != tcp_profile::System) {
+                poSocket->apply_profile(static_cast<csocket::Profile>(sh->profile));
+            }
+            auto conn = tcp_connection_ptr(new tcp_connection(std::make_unique<tcp_connection::impl>(poSocket, sh->index)));
+            try {
+                sh->handler(std::move(conn));
+            } catch (...) {
+                // Do nothing
+            }
+        }
+        /* More may be pending, hand the worker back to other tasks and come again */
+        if (sh->running->load()) {
+            post_accept(std::move(sh));
+        }
+    }
+
+    /* The poller only posts the accept task, the listener is read on its worker */
+    static int watch_shard(shard_ptr &sh) {
+        std::weak_ptr<shard> weak = sh;
+        return sh->poller->add(static_cast<int>(sh->listener.get_handle()), [weak]() {
+            if (auto sh = weak.lock()) {
+                post_accept(std::move(sh));
+            }
+        }, sh->watch);
+    }
+
+    int open_shard(shard &sh) {
+        if (sh.listener.open() != 0) {
+            return -1;
+        }
+        if (sh.listener.set_reuse_port(1) != 0) {
+            return -1;
+        }
+        if (sh.listener.bind(m_options.ip.c_str(), m_port) != 0) {
+            return -1;
+        }
+        if (m_port == 0) {
+            /* Let the first listener pick the port, the others join it */
+            SOCKADDR_T addr = sh.listener.get_socket_addr();
+            m_port = ntohs(addr.v4.sin_port);
+        }
+        if (sh.listener.listen(m_options.backlog) != 0) {
+            return -1;
+        }
+        return sh.listener.set_blocking_mode(0);
+    }
+
+public:
+    impl(const std::vector<worker_ptr> &workers, const tcp_server_options &options, connection_handler handler) :
+        m_workers(workers),
+        m_options(options),
+        m_handler(std::move(handler)),
+        m_shards{},
+        m_running{nullptr},
+        m_port(options.port) {
+    }
+
+    ~impl() {
+        stop();
+    }
+
+    int start() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (m_running != nullptr || m_workers.empty() || m_handler == nullptr) {
+            return -1;
+        }
+
+        auto poller = socket_poller::shared();
+        if (poller == nullptr) {
+            return -1;
+        }
+        auto running = std::make_shared<std::atomic<bool>>(true);
+        std::vector<shard_ptr> shards;
+        m_port = m_options.port;
+        for (size_t i = 0; i < m_workers.size(); i++) {
+            auto sh = std::make_shared<shard>();
+            sh->index = i;
+            sh->owner = m_workers[i];
+            sh->poller = poller;
+            sh->running = running;
+            sh->accept_batch = (m_options.accept_batch > 0 ? m_options.accept_batch : 1);
+            sh->profile = m_options.profile;
+            sh->handler = m_handler;
+            if (open_shard(*sh) != 0) {
+                return -1;
+            }
+            shards.push_back(std::move(sh));
+        }
+
+        /* The program is shared by the whole group, index N of the group is the N-th bound listener */
+        if (m_options.cpu_steering && shards[0]->listener.set_reuse_port_cpu_steering() != 0) {
+            return -1;
+        }
+
+        unsigned int cpus = std::thread::hardware_concurrency();
+        for (auto &sh : shards) {
+            auto &wk = m_workers[sh->index];
+            if (m_options.pin_workers && cpus > 0) {
+                wk->assign_to(static_cast<int>(sh->index % cpus));
+            }
+            if (wk->state() == worker::Idle) {
+                wk->start();
+            }
+            if (watch_shard(sh) != 0) {
+                running->store(false);
+                for (auto &other : shards) {
+                    poller->remove(other->watch);
+                }
+                return -1;
+            }
+        }
+
+        m_shards = std::move(shards);
+        m_running = std::move(running);
+        return 0;
+    }
+
+    int stop() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (m_running == nullptr) {
+            return -1;
+        }
+        m_running->store(false);
+        /* Shutdown takes the listener out of the group right away */
+        for (auto &sh : m_shards) {
+            sh->poller->remove(sh->watch);
+            sh->listener.disconnect();
+        }
+        m_shards.clear();
+        m_running = nullptr;
+        return 0;
+    }
+
+    bool running() const {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        return (m_running != nullptr);
+    }
+};
+
+/**
+ * @fn socket_tcp_server(const std::vector<worker_ptr> &workers, const tcp_server_options &options, connection_handler handler)
+ * @brief Construct a new sharded tcp server object
+ *
+ * @param workers       One listener is opened per worker
+ * @param options
+ * @param handler       Called on the accepting worker for every new connection
+ */
+socket_tcp_server::socket_tcp_server(const std::vector<worker_ptr> &workers, const tcp_server_options &options, connection_handler handler) :
+    m_impl(std::make_unique<socket_tcp_server::impl>(workers, options, std::move(handler))) {
+}
+socket_tcp_server::~socket_tcp_server() {
+}
+
+int socket_tcp_server::start() {
+    return m_impl->start();
+}
+int socket_tcp_server::stop() {
+    return m_impl->stop();
+}
+bool socket_tcp_server::running() const {
+    return m_impl->running();
+}
+uint16_t socket_tcp_server::port() const {
+    std::unique_lock<std::mutex> lock(m_impl->m_mtx);
+    return m_impl->m_port;
+}
+size_t socket_tcp_server::shard_count() const {
+    return m_impl->m_workers.size();
+}
+
+} // namespace ipc::core
@@ -0,0 +1,523 @@
+#include "socket/socket_tcp_pool.h"
+#include "osac/cframed_socket.h"
+#include "osac/csocket.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace ipc::core {
+
+using pool_clock = std::chrono::steady_clock;
+
+static inline int64_t pool_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(pool_clock::now().time_since_epoch()).count();
+}
+
+class tcp_client_pool::impl {
+    friend class tcp_client_pool;
+
+    struct pending {
+        response_handler handler{nullptr};
+        int64_t sent_ms = 0;
+    };
+
+    /*
+     * send_mtx serializes writers so requests are queued in the order they go on the wire,
+     * pending_mtx is the only lock the reader takes, so a writer waiting on a full send
+     * buffer never keeps the reader from draining responses. The wait is bounded by the
+     * request timeout, a peer that stops reading fails the request instead of the writers
+     * spinning or stalling forever.
+     */
+    struct connection {
+        csocket socket{static_cast<int32_t>(csocket::Type::SocketTcp), static_cast<int32_t>(csocket::Mode::Client)};
+        cframed_socket framed;
+        std::mutex send_mtx;
+        std::mutex pending_mtx;
+        std::deque<pending> queue;
+        std::atomic<bool> alive{true};
+        std::atomic<size_t> inflight{0};
+        std::atomic<int64_t> last_used_ms{0};
+
+        explicit connection(size_t max_frame) :
+            framed(socket, CFRAME_DEFAULT_READAHEAD, max_frame) {
+        }
+    };
+    using connection_ptr = std::shared_ptr<connection>;
+
+    struct endpoint {
+        std::string ip;
+        uint16_t port = 0;
+        std::vector<connection_ptr> conns;
+        size_t opening = 0; ///< Connects in progress, counted against max_connections
+    };
+
+    tcp_pool_options m_options;
+    std::map<std::string, endpoint> m_endpoints;
+    mutable std::mutex m_mtx;
+    std::atomic<bool> m_running{false};
+    int m_wakefd = -1;
+    std::thread m_reader;
+    /* Endpoints below min_idle, connected by the refill thread so the reader never blocks in connect */
+    std::mutex m_refill_mtx;
+    std::condition_variable m_refill_cv;
+    std::deque<endpoint> m_refills;
+    std::thread m_refiller;
+
+    static std::string endpoint_key(const std::string &ip, uint16_t port) {
+        return ip + ":" + std::to_string(port);
+    }
+
+    static bool would_block(int error) {
+        return (error == EAGAIN || error == EWOULDBLOCK || error == EINTR);
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        if (::write(m_wakefd, &one, sizeof(one)) < 0) {
+            // Already signalled
+        }
+    }
+
+    connection_ptr open_connection(const std::string &ip, uint16_t port) {
+        auto conn = std::make_shared<connection>(m_options.max_frame);
+        csocket &sk = conn->socket;
+        if (sk.open() != 0) {
+            return nullptr;
+        }
+        /* SO_SNDTIMEO also bounds a blocking connect */
+        if (m_options.connect_timeout_ms > 0) {
+            sk.set_send_timeout(m_options.connect_timeout_ms);
+        }
+        if (sk.connect(ip.c_str(), port) != 0) {
+            return nullptr;
+        }
+        if (m_options.profile != tcp_profile::System) {
+            sk.apply_profile(static_cast<csocket::Profile>(m_options.profile));
+        }
+        int32_t on = 1;
+        sk.set_option(SO_KEEPALIVE, SOL_SOCKET, &on, sizeof(on));
+        if (sk.set_blocking_mode(0) != 0) {
+            return nullptr;
+        }
+        conn->framed.set_send_timeout(m_options.request_timeout_ms);
+        conn->last_used_ms.store(pool_now_ms());
+        return conn;
+    }
+
+    /* Drop a connection, requests in flight are failed, the socket is closed with the last reference */
+    void fail(const connection_ptr &conn) {
+        std::deque<pending> failed;
+        {
+            std::unique_lock<std::mutex> lock(conn->pending_mtx);
+            conn->alive.store(false);
+            failed.swap(conn->queue);
+            conn->inflight.store(0);
+        }
+        conn->socket.disconnect();
+        for (auto &req : failed) {
+            complete(req, -1, buffer_ref());
+        }
+    }
+
+    static void complete(pending &req, int status, buffer_ref response) {
+        try {
+            req.handler(status, std::move(response));
+        } catch (...) {
+            // Do nothing
+        }
+    }
+
+    /* Add a connection opened outside the lock, the reader starts polling it after the wakeup */
+    void add_connection(const std::string &key, connection_ptr conn) {
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            auto it = m_endpoints.find(key);
+            if (it != m_endpoints.end()) {
+                it->second.opening--;
+                if (conn != nullptr && m_running.load()) {
+                    it->second.conns.push_back(conn);
+                    conn = nullptr;
+                }
+            }
+        }
+        if (conn != nullptr) {
+            fail(conn);
+        }
+        wake();
+    }
+
+    connection_ptr select_connection(const std::string &ip, uint16_t port) {
+        std::string key = endpoint_key(ip, port);
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (!m_running.load()) {
+            return nullptr;
+        }
+        endpoint &ep = m_endpoints.try_emplace(key, endpoint{ip, port, {}, 0}).first->second;
+
+        connection_ptr best = nullptr;
+        for (auto &conn : ep.conns) {
+            if (!conn->alive.load() || conn->inflight.load() >= m_options.max_pipeline) {
+                continue;
+            }
+            if (best == nullptr || conn->inflight.load() < best->inflight.load()) {
+                best = conn;
+            }
+        }
+        /* Pipeline only when no more connections may be opened */
+        if ((best == nullptr || best->inflight.load() > 0) && ep.conns.size() + ep.opening < m_options.max_connections) {
+            ep.opening++;
+            lock.unlock();
+            connection_ptr conn = open_connection(ip, port);
+            add_connection(key, conn);
+            if (conn != nullptr) {
+                return conn;
+            }
+        }
+        return best;
+    }
+
+    int send_request(const connection_ptr &conn, const char *data, size_t size, response_handler handler) {
+        std::unique_lock<std::mutex> send_lock(conn->send_mtx);
+        {
+            std::unique_lock<std::mutex> lock(conn->pending_mtx);
+            if (!conn->alive.load()) {
+                return -1;
+            }
+            conn->queue.push_back({std::move(handler), pool_now_ms()});
+            conn->inflight++;
+        }
+        conn->last_used_ms.store(pool_now_ms());
+        if (conn->framed.send(data, size) != 0) {
+            pending req;
+            {
+                std::unique_lock<std::mutex> lock(conn->pending_mtx);
+                if (conn->queue.empty()) {
+                    /* Already failed by the reader, the handler got -1 */
+                    return 0;
+                }
+                /* The caller gets -1, its handler must not be called as well */
+                req = std::move(conn->queue.back());
+                conn->queue.pop_back();
+                conn->inflight--;
+            }
+            send_lock.unlock();
+            fail(conn);
+            return -1;
+        }
+        return 0;
+    }
+
+    /* Complete the requests of every whole response received so far */
+    void read_responses(const connection_ptr &conn) {
+        while (conn->alive.load()) {
+            const char *frame = nullptr;
+            int32_t error = 0;
+            int bytes = conn->framed.receive(frame, &error);
+            if (bytes < 0) {
+                if (conn->framed.peer_closed() || !would_block(error)) {
+                    fail(conn);
+                }
+                return;
+            }
+
+            buffer_ref response = buffer_pool::acquire(bytes > 0 ? static_cast<size_t>(bytes) : 1);
+            if (!response) {
+                /* The response cannot be kept, the stream can no longer be matched to requests */
+                fail(conn);
+                return;
+            }
+            if (bytes > 0) {
+                memcpy(response.data(), frame, static_cast<size_t>(bytes));
+            }
+            response.resize(static_cast<size_t>(bytes));
+
+            pending req;
+            {
+                std::unique_lock<std::mutex> lock(conn->pending_mtx);
+                if (conn->queue.empty()) {
+                    lock.unlock();
+                    /* Unsolicited data, the stream can no longer be matched to requests */
+                    fail(conn);
+                    return;
+                }
+                req = std::move(conn->queue.front());
+                conn->queue.pop_front();
+                conn->inflight--;
+            }
+            conn->last_used_ms.store(pool_now_ms());
+            complete(req, 0, std::move(response));
+        }
+    }
+
+    /* Remove dead connections, fail stuck ones, trim idle ones and refill to min_idle */
+    void check_health() {
+        int64_t now = pool_now_ms();
+        std::vector<connection_ptr> drop;
+        std::vector<endpoint> refill;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            for (auto &[key, ep] : m_endpoints) {
+                size_t idle = 0;
+                for (auto it = ep.conns.begin(); it != ep.conns.end();) {
+                    auto &conn = *it;
+                    bool remove = !conn->alive.load();
+                    if (!remove && conn->inflight.load() > 0) {
+                        std::unique_lock<std::mutex> pending_lock(conn->pending_mtx);
+                        remove = (!conn->queue.empty() && now - conn->queue.front().sent_ms > m_options.request_timeout_ms);
+                    } else if (!remove) {
+                        remove = (++idle > m_options.min_idle && now - conn->last_used_ms.load() > m_options.idle_timeout_ms);
+                    }
+                    if (remove) {
+                        drop.push_back(conn);
+                        it = ep.conns.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                size_t want = (m_options.min_idle < m_options.max_connections ? m_options.min_idle : m_options.max_connections);
+                if (ep.conns.size() + ep.opening < want) {
+                    ep.opening++;
+                    refill.push_back({ep.ip, ep.port, {}, 0});
+                }
+            }
+        }
+        for (auto &conn : drop) {
+            fail(conn);
+        }
+        if (!refill.empty()) {
+            {
+                std::unique_lock<std::mutex> lock(m_refill_mtx);
+                for (auto &ep : refill) {
+                    m_refills.push_back(std::move(ep));
+                }
+            }
+            m_refill_cv.notify_one();
+        }
+    }
+
+    /* Open the connections queued by check_health(), a connect blocks up to connect_timeout_ms */
+    void run_refills() {
+        std::unique_lock<std::mutex> lock(m_refill_mtx);
+        while (m_running.load()) {
+            if (m_refills.empty()) {
+                m_refill_cv.wait(lock);
+                continue;
+            }
+            endpoint ep = std::move(m_refills.front());
+            m_refills.pop_front();
+            lock.unlock();
+            add_connection(endpoint_key(ep.ip, ep.port), open_connection(ep.ip, ep.port));
+            lock.lock();
+        }
+    }
+
+    void run() {
+        std::vector<connection_ptr> conns;
+        std::vector<pollfd> fds;
+        int64_t next_check = pool_now_ms() + m_options.health_interval_ms;
+
+        while (m_running.load()) {
+            conns.clear();
+            {
+                std::unique_lock<std::mutex> lock(m_mtx);
+                for (auto &[key, ep] : m_endpoints) {
+                    for (auto &conn : ep.conns) {
+                        if (conn->alive.load()) {
+                            conns.push_back(conn);
+                        }
+                    }
+                }
+            }
+            fds.assign(1, pollfd{m_wakefd, POLLIN, 0});
+            for (auto &conn : conns) {
+                fds.push_back(pollfd{static_cast<int>(conn->socket.get_handle()), POLLIN | POLLRDHUP, 0});
+            }
+
+            int64_t wait = next_check - pool_now_ms();
+            int ready = ::poll(fds.data(), fds.size(), static_cast<int>(wait > 0 ? wait : 0));
+            if (ready > 0) {
+                if (fds[0].revents & POLLIN) {
+                    uint64_t count;
+                    if (::read(m_wakefd, &count, sizeof(count)) < 0) {
+                        // Nothing to drain
+                    }
+                }
+                for (size_t i = 0; i < conns.size(); i++) {
+                    if (fds[i + 1].revents != 0) {
+                        /* Errors and hangups are reported by the failing receive */
+                        read_responses(conns[i]);
+                    }
+                }
+            }
+
+            if (pool_now_ms() >= next_check) {
+                check_health();
+                next_check = pool_now_ms() + m_options.health_interval_ms;
+            }
+        }
+    }
+
+public:
+    explicit impl(const tcp_pool_options &options) :
+        m_options(options),
+        m_endpoints{},
+        m_running{false} {
+        if (m_options.max_connections == 0) {
+            m_options.max_connections = 1;
+        }
+        if (m_options.max_pipeline == 0) {
+            m_options.max_pipeline = 1;
+        }
+        if (m_options.health_interval_ms == 0) {
+            m_options.health_interval_ms = 1;
+        }
+        m_wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_wakefd >= 0) {
+            m_running.store(true);
+            m_reader = std::thread([this]() {
+                run();
+            });
+            m_refiller = std::thread([this]() {
+                run_refills();
+            });
+        }
+    }
+
+    ~impl() {
+        close();
+        if (m_wakefd >= 0) {
+            ::close(m_wakefd);
+        }
+    }
+
+    int warm(const std::string &ip, uint16_t port) {
+        std::string key = endpoint_key(ip, port);
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            if (!m_running.load()) {
+                return -1;
+            }
+            endpoint &ep = m_endpoints.try_emplace(key, endpoint{ip, port, {}, 0}).first->second;
+            size_t want = (m_options.min_idle < m_options.max_connections ? m_options.min_idle : m_options.max_connections);
+            if (want == 0) {
+                want = 1;
+            }
+            if (ep.conns.size() + ep.opening < want) {
+                count = want - ep.conns.size() - ep.opening;
+                ep.opening += count;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            add_connection(key, open_connection(ip, port));
+        }
+        size_t opened = connections(ip, port);
+        return (opened > 0 ? static_cast<int>(opened) : -1);
+    }
+
+    int request(const std::string &ip, uint16_t port, const char *data, size_t size, response_handler handler) {
+        if (handler == nullptr) {
+            return -1;
+        }
+        connection_ptr conn = select_connection(ip, port);
+        if (conn == nullptr) {
+            return -1;
+        }
+        return send_request(conn, data, size, std::move(handler));
+    }
+
+    size_t connections(const std::string &ip, uint16_t port) const {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        auto it = m_endpoints.find(endpoint_key(ip, port));
+        if (it == m_endpoints.end()) {
+            return 0;
+        }
+        size_t count = 0;
+        for (auto &conn : it->second.conns) {
+            count += (conn->alive.load() ? 1 : 0);
+        }
+        return count;
+    }
+
+    void close() {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        wake();
+        {
+            /* Taken so the refill thread is either waiting or sees m_running cleared */
+            std::unique_lock<std::mutex> lock(m_refill_mtx);
+        }
+        m_refill_cv.notify_all();
+        if (m_reader.joinable()) {
+            m_reader.join();
+        }
+        /* Waits for a connect in progress, at most connect_timeout_ms */
+        if (m_refiller.joinable()) {
+            m_refiller.join();
+        }
+        std::vector<connection_ptr> conns;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            for (auto &[key, ep] : m_endpoints) {
+                conns.insert(conns.end(), ep.conns.begin(), ep.conns.end());
+                ep.conns.clear();
+            }
+        }
+        for (auto &conn : conns) {
+            fail(conn);
+        }
+    }
+};
+
+/**
+ * @fn tcp_client_pool(const tcp_pool_options &options)
+ * @brief Construct a new tcp client pool object and start its reader thread
+ *
+ * @param options
+ */
+tcp_client_pool::tcp_client_pool(const tcp_pool_options &options) :
+    m_impl(std::make_unique<tcp_client_pool::impl>(options)) {
+}
+tcp_client_pool::~tcp_client_pool() {
+}
+
+int tcp_client_pool::warm(const std::string &ip, uint16_t port) {
+    return m_impl->warm(ip, port);
+}
+int tcp_client_pool::request(const std::string &ip, uint16_t port, const char *data, size_t size, response_handler handler) {
+    return m_impl->request(ip, port, data, size, std::move(handler));
+}
+std::future<buffer_ref> tcp_client_pool::request(const std::string &ip, uint16_t port, const char *data, size_t size) {
+    auto promise = std::make_shared<std::promise<buffer_ref>>();
+    auto future = promise->get_future();
+    int ret = m_impl->request(ip, port, data, size, [promise](int status, buffer_ref response) {
+        if (status == 0) {
+            promise->set_value(std::move(response));
+        } else {
+            promise->set_exception(std::make_exception_ptr(std::runtime_error("tcp request failed")));
+        }
+    });
+    if (ret != 0) {
+        promise->set_exception(std::make_exception_ptr(std::runtime_error("tcp request could not be sent")));
+    }
+    return future;
+}
+size_t tcp_client_pool::connections(const std::string &ip, uint16_t port) const {
+    return m_impl->connections(ip, port);
+}
+void tcp_client_pool::close() {
+    m_impl->close();
+}
+
+} // namespace ipc::core
@@ -0,0 +1,277 @@
+#include "socket/socket_udp.h"
+#include "osac/csocket.h"
+#include "socket_poller_p.h"
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+
+namespace ipc::core {
+
+class multicast_receiver::impl {
+    friend class multicast_receiver;
+
+    /* One socket per worker, shared with the receive task that keeps it alive after stop() */
+    struct shard {
+        size_t index = 0;
+        std::weak_ptr<worker> owner{};
+        csocket receiver{static_cast<int32_t>(csocket::Type::SocketUdp), static_cast<int32_t>(csocket::Mode::Server)};
+        std::shared_ptr<socket_poller> poller{nullptr};
+        uint64_t watch = 0;
+        std::shared_ptr<std::atomic<bool>> running{nullptr};
+        size_t recv_batch = 0;
+        size_t max_datagram = 0;
+        std::vector<char> buffer;
+        buffer_ref pending{};
+        datagram_handler handler{nullptr};
+        buffer_handler pooled{nullptr};
+    };
+    using shard_ptr = std::shared_ptr<shard>;
+
+    std::vector<worker_ptr> m_workers;
+    multicast_receiver_options m_options;
+    datagram_handler m_handler{nullptr};
+    buffer_handler m_pooled{nullptr};
+    std::vector<shard_ptr> m_shards;
+    std::shared_ptr<std::atomic<bool>> m_running{nullptr};
+    mutable std::mutex m_mtx;
+
+    static void post_receive(shard_ptr sh) {
+        if (auto wk = sh->owner.lock()) {
+            wk->add_nocallback_task([sh]() {
+                receive_datagrams(sh);
+            });
+        }
+    }
+
+    static int receive_one(shard &sh, int32_t &error) {
+        SOCKADDR_T addr;
+        if (sh.pooled == nullptr) {
+            int bytes = sh.receiver.receive_from(sh.buffer.data(), sh.buffer.size(), addr, &error);
+            if (bytes > 0) {
+                sh.handler(sh.buffer.data(), static_cast<size_t>(bytes), sh.index);
+            }
+            return bytes;
+        }
+
+        /* Received straight into a pooled buffer which is handed over as it is */
+        if (!buffer_pool::reserve(sh.pending, sh.max_datagram)) {
+            return -1;
+        }
+        int bytes = sh.receiver.receive_from(sh.pending.data(), sh.max_datagram, addr, &error);
+        if (bytes > 0) {
+            sh.pending.resize(static_cast<size_t>(bytes));
+            sh.pooled(std::move(sh.pending), sh.index);
+        }
+        return bytes;
+    }
+
+    /* Posted when the socket is readable, receives until it would block and waits for the poller again */
+    static void receive_datagrams(shard_ptr sh) {
+        for (size_t i = 0; i < sh->recv_batch; i++) {
+            if (!sh->running->load()) {
+                return;
+            }
+            int32_t error = 0;
+            int bytes = 0;
+            try {
+                bytes = receive_one(*sh, error);
+            } catch (...) {
+                // Do nothing
+            }
+            if (bytes < 0 && error != EINTR) {
+                sh->poller->rearm(sh->watch);
+                return;
+            }
+        }
+        /* More may be queued, hand the worker back to other tasks and come again */
+        if (sh->running->load()) {
+            post_receive(std::move(sh));
+        }
+    }
+
+    /* The poller only posts the receive task, the socket is read on its worker */
+    static int watch_shard(shard_ptr &sh) {
+        std::weak_ptr<shard> weak = sh;
+        return sh->poller->add(static_cast<int>(sh->receiver.get_handle()), [weak]() {
+            if (auto sh = weak.lock()) {
+                post_receive(std::move(sh));
+            }
+        }, sh->watch);
+    }
+
+    size_t shard_count() const {
+        if (m_options.fanout == multicast_fanout::ByGroup && m_options.groups.size() < m_workers.size()) {
+            return m_options.groups.size();
+        }
+        return m_workers.size();
+    }
+
+    int join(shard &sh, const multicast_group &group) {
+        const char *iface = m_options.iface.c_str();
+        if (group.source.empty()) {
+            return sh.receiver.join_multicast(group.group.c_str(), iface);
+        }
+        return sh.receiver.join_source_multicast(group.group.c_str(), group.source.c_str(), iface);
+    }
+
+    int open_shard(shard &sh, size_t count) {
+        if (sh.receiver.open() != 0) {
+            return -1;
+        }
+        if (count > 1 && sh.receiver.set_reuse_port(1) != 0) {
+            return -1;
+        }
+        /* Only take the groups joined on this socket, not every group joined on the port */
+        if (sh.receiver.set_multicast_all(0) != 0) {
+            return -1;
+        }
+        if (m_options.fanout == multicast_fanout::ByKey && count > 1 &&
+            sh.receiver.set_shard_filter(m_options.key_offset, static_cast<uint32_t>(count), static_cast<uint32_t>(sh.index)) != 0) {
+            return -1;
+        }
+        if (m_options.recv_buff_size > 0 && sh.receiver.set_recv_buff_size(m_options.recv_buff_size) != 0) {
+            return -1;
+        }
+        if (sh.receiver.bind(SOCKET_IP_ADDR_ANY, m_options.port) != 0) {
+            return -1;
+        }
+        for (size_t i = 0; i < m_options.groups.size(); i++) {
+            if (m_options.fanout == multicast_fanout::ByGroup && (i % count) != sh.index) {
+                continue;
+            }
+            if (join(sh, m_options.groups[i]) != 0) {
+                return -1;
+            }
+        }
+        return sh.receiver.set_blocking_mode(0);
+    }
+
+public:
+    impl(const std::vector<worker_ptr> &workers, const multicast_receiver_options &options, datagram_handler handler, buffer_handler pooled) :
+        m_workers(workers),
+        m_options(options),
+        m_handler(std::move(handler)),
+        m_pooled(std::move(pooled)),
+        m_shards{},
+        m_running{nullptr} {
+    }
+
+    ~impl() {
+        stop();
+    }
+
+    int start() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        size_t count = shard_count();
+        if (m_running != nullptr || count == 0 || (m_handler == nullptr && m_pooled == nullptr)) {
+            return -1;
+        }
+
+        auto poller = socket_poller::shared();
+        if (poller == nullptr) {
+            return -1;
+        }
+        auto running = std::make_shared<std::atomic<bool>>(true);
+        std::vector<shard_ptr> shards;
+        for (size_t i = 0; i < count; i++) {
+            auto sh = std::make_shared<shard>();
+            sh->index = i;
+            sh->owner = m_workers[i];
+            sh->poller = poller;
+            sh->running = running;
+            sh->recv_batch = (m_options.recv_batch > 0 ? m_options.recv_batch : 1);
+            sh->max_datagram = (m_options.max_datagram > 0 ? m_options.max_datagram : 1);
+            if (m_pooled == nullptr) {
+                sh->buffer.resize(sh->max_datagram);
+            }
+            sh->handler = m_handler;
+            sh->pooled = m_pooled;
+            if (open_shard(*sh, count) != 0) {
+                return -1;
+            }
+            shards.push_back(std::move(sh));
+        }
+
+        unsigned int cpus = std::thread::hardware_concurrency();
+        for (auto &sh : shards) {
+            auto &wk = m_workers[sh->index];
+            if (m_options.pin_workers && cpus > 0) {
+                wk->assign_to(static_cast<int>(sh->index % cpus));
+            }
+            if (wk->state() == worker::Idle) {
+                wk->start();
+            }
+            if (watch_shard(sh) != 0) {
+                running->store(false);
+                for (auto &other : shards) {
+                    poller->remove(other->watch);
+                }
+                return -1;
+            }
+        }
+
+        m_shards = std::move(shards);
+        m_running = std::move(running);
+        return 0;
+    }
+
+    int stop() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (m_running == nullptr) {
+            return -1;
+        }
+        m_running->store(false);
+        for (auto &sh : m_shards) {
+            sh->poller->remove(sh->watch);
+        }
+        m_shards.clear();
+        m_running = nullptr;
+        return 0;
+    }
+
+    bool running() const {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        return (m_running != nullptr);
+    }
+};
+
+/**
+ * @fn multicast_receiver(const std::vector<worker_ptr> &workers, const multicast_receiver_options &options, datagram_handler handler)
+ * @brief Construct a new multicast receiver object
+ *
+ * @param workers       One socket is opened per worker
+ * @param options
+ * @param handler       Called on the receiving worker for every datagram
+ */
+multicast_receiver::multicast_receiver(const std::vector<worker_ptr> &workers, const multicast_receiver_options &options, datagram_handler handler) :
+    m_impl(std::make_unique<multicast_receiver::impl>(workers, options, std::move(handler), nullptr)) {
+}
+
+/**
+ * @fn multicast_receiver(const std::vector<worker_ptr> &workers, const multicast_receiver_options &options, buffer_handler handler)
+ * @brief Construct a new multicast receiver object delivering pooled buffers
+ *
+ * @param workers       One socket is opened per worker
+ * @param options
+ * @param handler       Called on the receiving worker with every datagram's buffer
+ */
+multicast_receiver::multicast_receiver(const std::vector<worker_ptr> &workers, const multicast_receiver_options &options, buffer_handler handler) :
+    m_impl(std::make_unique<multicast_receiver::impl>(workers, options, nullptr, std::move(handler))) {
+}
+multicast_receiver::~multicast_receiver() {
+}
+
+int multicast_receiver::start() {
+    return m_impl->start();
+}
+int multicast_receiver::stop() {
+    return m_impl->stop();
+}
+bool multicast_receiver::running() const {
+    return m_impl->running();
+}
+size_t multicast_receiver::shard_count() const {
+    return m_impl->shard_count();
+}
+
+} // namespace ipc::core
@@ -26,10 +26,9 @@ public:
         std::cout << "function2: sender " << x->sender() << std::endl;
         try {
             if (x != nullptr) {
-                ipc::core::message_args<int *, double> args(x->data(), x->size());
-                if (args.data().has_value()) {
-                    auto tp = args.data().get();
-                    std::cout << "args: <int> = " << *std::get<int *>(tp) << " <double> = " << std::get<double>(tp) << std::endl;
+                ipc::core::message_parser<int *, double> args(x);
+                if (args.valid()) {
+                    std::cout << "args: <int> = " << *args.get<0>() << " <double> = " << args.get<1>() << std::endl;
                 }
             }
         } catch (...) {
@@ -148,9 +147,16 @@ int main() {
     ipc::core::evloop_ptr el1 = ipc::core::make_evloop(ipc::core::make_worker());
     ipc::core::evloop_ptr el2 = ipc::core::make_evloop(ipc::core::make_worker());
 
+    auto sensor_handle = ipc::core::evloop::make_handle([](ipc::core::message_ptr mesg) {
+        std::cout << "sensor route: receiver " << mesg->receiver() << std::endl;
+    });
+    el1->add_route("sensor/*", sensor_handle);
+
     el1->start();
     el2->start();
 
+    el1->post(ipc::core::message::create("main", "sensor/temperature", "21.5"));
+
     ipc::core::const_worker_ptr ev_worker = el1->get_worker();
     ev_worker->task_count();
 
@@ -1,5 +1,6 @@
 #include "concurrent/mesg.h"
 #include "concurrent/mesg_args.h"
+#include "concurrent/mesg_codec.h"
 #include "concurrent/eventloop.h"
 #include <iostream>
 #include "concurrent/except.h"
@@ -10,6 +11,8 @@
 #include "concurrent/condition_trigger.h"
 #include "concurrent/task_chain.h"
 #include "concurrent/callback.h"
+#include "concurrent/worker_pool.h"
+#include "concurrent/timer.h"
 
 static std::mutex mtx;
 static std::mutex task_mtx;
@@ -116,6 +119,154 @@ int main() {
         std::cout << "other exception\n";
     }
 
+    {
+        /* Both formats round trip, truncated or foreign buffers are rejected */
+        using text_codec = ipc::core::message_codec<int, std::string, std::vector<int>>;
+        std::string text = text_codec::encode(7, "seven", {1, 2, 3});
+        std::tuple<int, std::string, std::vector<int>> text_out;
+        bool text_ok = text_codec::decode(text.data(), text.size(), text_out) && std::get<0>(text_out) == 7
+                       && std::get<1>(text_out) == "seven" && std::get<2>(text_out).size() == 3;
+        bool text_short = text_codec::decode(text.data(), text.size() - 1, text_out);
+        std::tuple<int, int, std::vector<int>> text_other_out;
+        std::tuple<int, std::string> text_prefix_out;
+        bool text_other = ipc::core::message_codec<int, int, std::vector<int>>::decode(text.data(), text.size(), text_other_out)
+                          || ipc::core::message_codec<int, std::string>::decode(text.data(), text.size(), text_prefix_out)
+                          || ipc::core::message_parser<int, std::string>(text.data(), text.size()).valid();
+
+        using pod = ipc::core::pod_codec<char, double, int>;
+        char image[pod::size];
+        pod::encode(image, sizeof(image), 'p', 2.5, 42);
+        std::tuple<char, double, int> pod_out;
+        bool pod_ok = ipc::core::message_codec<char, double, int>::decode(image, sizeof(image), pod_out) && std::get<0>(pod_out) == 'p'
+                      && std::get<1>(pod_out) == 2.5 && std::get<2>(pod_out) == 42;
+        bool pod_short = pod::decode(image, sizeof(image) - 1, pod_out);
+        std::tuple<char, double, short> other_out;
+        bool pod_other = ipc::core::message_codec<char, double, short>::decode(image, sizeof(image), other_out);
+        printf("codec element: %d (truncated %d, wrong schema %d), pod: %d (truncated %d, wrong schema %d)\n", text_ok, text_short, text_other, pod_ok, pod_short, pod_other);
+    }
+
+    {
+        ipc::core::worker_pool pool(4);
+        std::atomic<int> done{0};
+        pool.start();
+        for (int i = 0; i < 1000; i++) {
+            pool.add_nocallback_task([&pool, &done]() {
+                /* Spawned tasks stay on this thread unless an idle one steals them */
+                pool.add_nocallback_task([&done]() {
+                    done++;
+                });
+                done++;
+            });
+        }
+        while (done.load() < 2000) {
+            std::this_thread::sleep_for(1ms);
+        }
+        printf("pool executed: %zu, stolen: %zu\n", pool.executed_count(), pool.stolen_count());
+        pool.quit();
+        pool.join();
+    }
+
+    {
+        /* A burst is drained in batches, not one queue operation per task */
+        ipc::core::worker burst;
+        std::atomic<int> done{0};
+        for (int i = 0; i < 5000; i++) {
+            burst.add_nocallback_task([&done]() {
+                done++;
+            });
+        }
+        burst.start();
+        while (done.load() < 5000) {
+            std::this_thread::sleep_for(1ms);
+        }
+        auto stats = burst.stats();
+        printf("burst executed: %zu, batches: %zu, max batch: %zu\n", stats.tasks, stats.batches, stats.max_size);
+        burst.quit();
+        burst.join();
+    }
+
+    {
+        /* Queued before start, runs as: due deadline, High, pending deadline, Normal, Low */
+        ipc::core::worker lanes;
+        std::string order;
+        std::mutex order_mtx;
+        auto mark = [&order, &order_mtx](char c) {
+            return ipc::core::make_light_task([&order, &order_mtx, c]() {
+                std::unique_lock<std::mutex> lock(order_mtx);
+                order += c;
+            });
+        };
+        lanes.add_task(mark('L'), ipc::core::worker::Low);
+        lanes.add_task(mark('N'), ipc::core::worker::Normal);
+        lanes.add_task(mark('H'), ipc::core::worker::High);
+        lanes.add_task(mark('D'), std::chrono::steady_clock::now() + 10ms);
+        lanes.add_task(mark('d'), std::chrono::steady_clock::now() - 1ms);
+        auto last = mark('.');
+        lanes.add_task(last, ipc::core::worker::Low);
+        lanes.start();
+        last->get();
+        printf("lane order: %s\n", order.c_str());
+        lanes.quit();
+        lanes.join();
+    }
+
+    {
+        /* Timers are kept and fired by the worker thread, no osal timer involved */
+        ipc::core::worker timers;
+        std::atomic<int> ticks{0};
+        std::atomic<long> late_us{-1};
+        timers.start();
+        auto start = std::chrono::steady_clock::now();
+        auto every = timers.post_every(2ms, [&ticks]() {
+            ticks++;
+        });
+        timers.post_after(5ms, [&late_us, start]() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            late_us = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed - 5ms).count());
+        });
+        auto cancelled = timers.post_after(5ms, []() {
+            printf("cancelled timer ran\n");
+        });
+        cancelled.cancel();
+        std::this_thread::sleep_for(21ms);
+        every.cancel();
+        int seen = ticks.load();
+        std::this_thread::sleep_for(10ms);
+        printf("timer ticks: %d (after cancel: %d), post_after late by %ld us\n", seen, ticks.load() - seen, late_us.load());
+        timers.quit();
+        timers.join();
+    }
+
+    {
+        /* A periodic timer on the worker thread, a blocked worker coalesces expirations */
+        auto timer_wk = ipc::core::make_worker();
+        timer_wk->start();
+        ipc::core::timer periodic(timer_wk, 500us, ipc::core::timer::Periodic);
+        std::atomic<int> calls{0};
+        periodic.set_callback([&calls]() {
+            calls++;
+        });
+        periodic.start();
+        std::this_thread::sleep_for(10ms);
+        timer_wk->add_nocallback_task([]() {
+            std::this_thread::sleep_for(5ms);
+        });
+        std::this_thread::sleep_for(10ms);
+        periodic.stop();
+        printf("timer calls: %d, expirations: %lu, running: %d\n", calls.load(), static_cast<unsigned long>(periodic.expirations()), periodic.is_running());
+
+        ipc::core::timer once(timer_wk, 2ms, ipc::core::timer::OneShot);
+        std::atomic<int> fired{0};
+        once.set_callback([&fired]() {
+            fired++;
+        });
+        once.start();
+        std::this_thread::sleep_for(10ms);
+        printf("one-shot fired: %d, running: %d\n", fired.load(), once.is_running());
+        timer_wk->quit();
+        timer_wk->join();
+    }
+
     auto chain = std::make_shared<sequenctial_task>();
     chain->init_task();
     wk->add_task(chain);
@@ -0,0 +1,252 @@
+#include "socket/socket_local.h"
+#include "socket/socket_tcp.h"
+#include "socket/socket_tcp_pool.h"
+#include "socket/socket_udp.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+static void local_echo(ipc::core::local_socket_type type, const std::string &path) {
+    ipc::core::socket_local_server server(path, type);
+    if (server.open() != 0 || server.bind() != 0 || server.listen(4) != 0) {
+        std::cout << "server " << path << " failed\n";
+        return;
+    }
+
+    std::thread server_thread([&server]() {
+        auto client = server.accept();
+        if (client == nullptr) {
+            return;
+        }
+        std::cout << "accepted pid " << client->peer_cred().pid << " uid " << client->peer_cred().uid << std::endl;
+
+        char buff[256];
+        int bytes = 0;
+        while ((bytes = client->recv(buff, sizeof(buff))) > 0) {
+            client->send(buff, bytes);
+        }
+    });
+
+    ipc::core::socket_local_client client(type);
+    if (client.open() == 0 && client.connect(path) == 0) {
+        const char *messages[] = {"hello", "local", "socket"};
+        size_t total = 0;
+        for (auto mesg : messages) {
+            client.send(mesg, strlen(mesg));
+            total += strlen(mesg);
+        }
+        /* SeqPacket keeps one recv per send, a stream may merge them */
+        char buff[256];
+        while (total > 0) {
+            int bytes = client.recv(buff, sizeof(buff));
+            if (bytes <= 0) {
+                break;
+            }
+            total -= bytes;
+            std::cout << path << " recv: " << std::string(buff, bytes) << std::endl;
+        }
+        client.close();
+    } else {
+        std::cout << "client connect " << path << " failed\n";
+    }
+
+    server_thread.join();
+    server.close();
+}
+
+static void tcp_sharded_echo(size_t worker_count, size_t client_count) {
+    std::vector<ipc::core::worker_ptr> workers;
+    for (size_t i = 0; i < worker_count; i++) {
+        workers.push_back(ipc::core::make_worker());
+    }
+
+    std::mutex mtx;
+    std::vector<size_t> per_shard(worker_count, 0);
+    ipc::core::tcp_server_options options;
+    options.ip = "127.0.0.1";
+    ipc::core::socket_tcp_server server(workers, options, [&](ipc::core::tcp_connection_ptr conn) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            per_shard[conn->shard()]++;
+        }
+        char buff[64];
+        int bytes = conn->recv(buff, sizeof(buff));
+        if (bytes > 0) {
+            conn->send(buff, bytes);
+        }
+    });
+    if (server.start() != 0) {
+        std::cout << "tcp server start failed\n";
+        return;
+    }
+
+    size_t echoed = 0;
+    for (size_t i = 0; i < client_count; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(server.port());
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        char buff[8] = {};
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0 && send(fd, "ping", 4, 0) == 4 && recv(fd, buff, sizeof(buff), 0) == 4) {
+            echoed++;
+        }
+        close(fd);
+    }
+    server.stop();
+
+    std::cout << "tcp port " << server.port() << " echoed " << echoed << "/" << client_count << ", per shard:";
+    for (auto count : per_shard) {
+        std::cout << " " << count;
+    }
+    std::cout << std::endl;
+    for (auto &wk : workers) {
+        wk->quit();
+        wk->join();
+    }
+}
+
+static void tcp_pool_pipelined(size_t request_count) {
+    std::vector<ipc::core::worker_ptr> workers = {ipc::core::make_worker()};
+    std::mutex mtx;
+    std::vector<std::thread> echoers;
+    ipc::core::tcp_server_options options;
+    options.ip = "127.0.0.1";
+    options.pin_workers = false;
+    /* Frames are echoed byte for byte, so responses come back in request order */
+    ipc::core::socket_tcp_server server(workers, options, [&](ipc::core::tcp_connection_ptr conn) {
+        std::lock_guard<std::mutex> lock(mtx);
+        echoers.emplace_back([conn]() {
+            char buff[4096];
+            while (true) {
+                int bytes = conn->recv(buff, sizeof(buff));
+                if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EINTR)) {
+                    break;
+                }
+                if (bytes > 0) {
+                    conn->send(buff, bytes);
+                }
+            }
+        });
+    });
+    if (server.start() != 0) {
+        std::cout << "tcp server start failed\n";
+        return;
+    }
+
+    ipc::core::tcp_pool_options pool_options;
+    pool_options.min_idle = 1;
+    pool_options.max_connections = 2;
+    pool_options.max_pipeline = 128;
+    ipc::core::tcp_client_pool pool(pool_options);
+    std::cout << "tcp pool warm " << pool.warm("127.0.0.1", server.port()) << std::endl;
+
+    std::atomic<size_t> matched{0};
+    std::atomic<size_t> done{0};
+    for (size_t i = 0; i < request_count; i++) {
+        std::string payload = "request " + std::to_string(i);
+        int ret = pool.request("127.0.0.1", server.port(), payload.data(), payload.size(), [&, payload](int status, ipc::core::buffer_ref response) {
+            if (status == 0 && std::string(response.data(), response.size()) == payload) {
+                matched++;
+            }
+            done++;
+        });
+        if (ret != 0) {
+            done++;
+        }
+    }
+    auto reply = pool.request("127.0.0.1", server.port(), "future", 6);
+    std::string future_reply;
+    try {
+        auto response = reply.get();
+        future_reply.assign(response.data(), response.size());
+    } catch (const std::exception &e) {
+        future_reply = e.what();
+    }
+    while (done.load() < request_count) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::cout << "tcp pool matched " << matched.load() << "/" << request_count << ", future " << future_reply
+              << ", connections " << pool.connections("127.0.0.1", server.port()) << std::endl;
+    pool.close();
+    server.stop();
+    for (auto &echoer : echoers) {
+        echoer.join();
+    }
+    for (auto &wk : workers) {
+        wk->quit();
+        wk->join();
+    }
+}
+
+static void multicast_fanout(ipc::core::multicast_fanout fanout, const char *name) {
+    std::vector<ipc::core::worker_ptr> workers;
+    for (size_t i = 0; i < 4; i++) {
+        workers.push_back(ipc::core::make_worker());
+    }
+
+    std::mutex mtx;
+    std::vector<size_t> per_shard(workers.size(), 0);
+    ipc::core::multicast_receiver_options options;
+    options.groups = {{"239.1.2.3"}, {"239.1.2.4"}};
+    options.port = 45679;
+    options.iface = "127.0.0.1";
+    options.fanout = fanout;
+    ipc::core::multicast_receiver receiver(workers, options, [&](ipc::core::buffer_ref data, size_t shard) {
+        if (data.size() != sizeof(uint32_t)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        per_shard[shard]++;
+    });
+    if (receiver.start() != 0) {
+        std::cout << "multicast receiver start failed\n";
+        return;
+    }
+
+    /* Loopback sender, 100 datagrams to each group with a big endian key in front */
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    in_addr iface{};
+    inet_pton(AF_INET, "127.0.0.1", &iface);
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+    for (auto &group : options.groups) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(options.port);
+        inet_pton(AF_INET, group.group.c_str(), &addr.sin_addr);
+        for (uint32_t key = 0; key < 100; key++) {
+            uint32_t payload = htonl(key);
+            sendto(fd, &payload, sizeof(payload), 0, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        }
+    }
+    close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    receiver.stop();
+
+    std::cout << "multicast " << name << " shards " << receiver.shard_count() << ", per shard:";
+    for (auto count : per_shard) {
+        std::cout << " " << count;
+    }
+    std::cout << std::endl;
+    for (auto &wk : workers) {
+        wk->quit();
+        wk->join();
+    }
+}
+
+int main() {
+    local_echo(ipc::core::local_socket_type::SeqPacket, "/tmp/ipc_local_seqpacket");
+    local_echo(ipc::core::local_socket_type::Stream, "@ipc_local_stream");
+    tcp_sharded_echo(4, 64);
+    tcp_pool_pipelined(200);
+    multicast_fanout(ipc::core::multicast_fanout::ByGroup, "by group");
+    multicast_fanout(ipc::core::multicast_fanout::ByKey, "by key");
+    multicast_fanout(ipc::core::multicast_fanout::Replicate, "replicate");
+    return 0;
+}